@@ -0,0 +1,216 @@
+#include "qr_reader_c.h"
+#include "../core/qr_detector.h"
+#include "../io/image_loader.h"
+#include "../utils/logger.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct qr_reader_detector {
+    QRDetector detector;
+};
+
+namespace {
+
+const char* VERSION = "1.0.0";
+
+// Хост не ждёт INFO-строк в своём выводе: пока он сам не выбрал уровень, библиотека пишет
+// только предупреждения и ошибки
+std::atomic<bool> log_level_chosen{false};
+
+void applyDefaultLogLevel() {
+    bool expected = false;
+    if (log_level_chosen.compare_exchange_strong(expected, true)) {
+        Logger::setLogLevel(Logger::WARNING);
+    }
+}
+
+void setError(qr_reader_result* result, const std::string& message) {
+    std::snprintf(result->error_message, sizeof(result->error_message), "%s", message.c_str());
+}
+
+bool fillCode(qr_reader_code& code, const std::string& data, double confidence,
+              const std::vector<cv::Point>& bbox) {
+    code.data = static_cast<char*>(std::malloc(data.size() + 1));
+    if (!code.data) return false;
+    std::memcpy(code.data, data.data(), data.size());
+    code.data[data.size()] = '\0';
+    code.data_size = data.size();
+    code.confidence = confidence;
+    for (size_t i = 0; i < 4; ++i) {
+        code.bounding_box[2 * i] = i < bbox.size() ? bbox[i].x : 0;
+        code.bounding_box[2 * i + 1] = i < bbox.size() ? bbox[i].y : 0;
+    }
+    return true;
+}
+
+int fillResult(const QRDetector::DetectionResult& detection, qr_reader_result* result) {
+    if (!detection.success) {
+        setError(result, detection.error_message);
+        return QR_READER_NOT_FOUND;
+    }
+
+    // Одиночная детекция не заполняет codes — приводим к одному виду
+    size_t count = detection.codes.empty() ? 1 : detection.codes.size();
+    result->codes = static_cast<qr_reader_code*>(std::calloc(count, sizeof(qr_reader_code)));
+    if (!result->codes) {
+        setError(result, "Out of memory");
+        return QR_READER_ERROR_INTERNAL;
+    }
+    result->code_count = count;
+
+    bool ok = true;
+    if (detection.codes.empty()) {
+        ok = fillCode(result->codes[0], detection.data, detection.confidence, detection.bounding_box);
+    } else {
+        for (size_t i = 0; i < count && ok; ++i) {
+            const auto& code = detection.codes[i];
+            ok = fillCode(result->codes[i], code.data, code.confidence, code.bounding_box);
+        }
+    }
+    if (!ok) {
+        qr_reader_result_free(result);
+        setError(result, "Out of memory");
+        return QR_READER_ERROR_INTERNAL;
+    }
+    return QR_READER_FOUND;
+}
+
+int detect(qr_reader_detector* detector, const cv::Mat& image, qr_reader_result* result) {
+    return fillResult(detector->detector.detectFromImage(image), result);
+}
+
+// Исключения не должны пересекать C-границу: функции декодирования выполняют тело целиком
+// через эту обёртку, прочие точки входа, которые могут бросить, ловят всё сами.
+// Не бросают только qr_reader_version, qr_reader_destroy и qr_reader_result_free
+template <typename Body>
+int guarded(qr_reader_result* result, Body body) {
+    try {
+        return body();
+    } catch (const std::exception& e) {
+        qr_reader_result_free(result);
+        setError(result, e.what());
+    } catch (...) {
+        qr_reader_result_free(result);
+        setError(result, "Unknown error");
+    }
+    return QR_READER_ERROR_INTERNAL;
+}
+
+} // namespace
+
+const char* qr_reader_version(void) {
+    return VERSION;
+}
+
+int qr_reader_set_log_level(qr_reader_log_level level) {
+    if (level < QR_READER_LOG_DEBUG || level > QR_READER_LOG_OFF) {
+        return QR_READER_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        log_level_chosen = true;
+        Logger::setLogLevel(static_cast<Logger::Level>(level));
+        return 0;
+    } catch (...) {
+        return QR_READER_ERROR_INTERNAL;
+    }
+}
+
+qr_reader_detector* qr_reader_create(void) {
+    try {
+        applyDefaultLogLevel();
+        qr_reader_detector* handle = new qr_reader_detector();
+        // Кадр принадлежит вызывающему — не держим на него ссылку после возврата
+        handle->detector.setRetainProcessedImage(false);
+        return handle;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void qr_reader_destroy(qr_reader_detector* detector) {
+    // Деструкторы noexcept — бросить здесь нечему
+    delete detector;
+}
+
+void qr_reader_set_preprocessing(qr_reader_detector* detector, int enabled) {
+    try {
+        if (detector) {
+            detector->detector.setPreprocessingEnabled(enabled != 0);
+        }
+    } catch (...) {
+    }
+}
+
+void qr_reader_set_multi(qr_reader_detector* detector, int enabled) {
+    try {
+        if (detector) {
+            detector->detector.setMultipleQRDetection(enabled != 0);
+        }
+    } catch (...) {
+    }
+}
+
+int qr_reader_decode(qr_reader_detector* detector, const uint8_t* pixels, int width, int height, size_t stride,
+                     qr_reader_pixel_format format, qr_reader_result* result) {
+    if (!result) {
+        return QR_READER_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded(result, [&]() -> int {
+        std::memset(result, 0, sizeof(*result));
+
+        int type;
+        size_t bytes_per_pixel;
+        switch (format) {
+            case QR_READER_PIXEL_GRAY8:  type = CV_8UC1; bytes_per_pixel = 1; break;
+            case QR_READER_PIXEL_BGR24:  type = CV_8UC3; bytes_per_pixel = 3; break;
+            case QR_READER_PIXEL_BGRA32: type = CV_8UC4; bytes_per_pixel = 4; break;
+            default:
+                setError(result, "Unknown pixel format");
+                return QR_READER_ERROR_INVALID_ARGUMENT;
+        }
+
+        if (!detector || !pixels || width <= 0 || height <= 0 ||
+            stride < static_cast<size_t>(width) * bytes_per_pixel) {
+            setError(result, "Invalid detector, buffer or dimensions");
+            return QR_READER_ERROR_INVALID_ARGUMENT;
+        }
+
+        // Заголовок поверх памяти вызывающего: детектор читает её на месте, без копии
+        cv::Mat image(height, width, type, const_cast<uint8_t*>(pixels), stride);
+        return detect(detector, image, result);
+    });
+}
+
+int qr_reader_decode_encoded(qr_reader_detector* detector, const uint8_t* data, size_t size,
+                             qr_reader_result* result) {
+    if (!result) {
+        return QR_READER_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded(result, [&]() -> int {
+        std::memset(result, 0, sizeof(*result));
+
+        if (!detector || !data || size == 0) {
+            setError(result, "Invalid detector or buffer");
+            return QR_READER_ERROR_INVALID_ARGUMENT;
+        }
+
+        auto load = ImageLoader::loadFromMemory(data, size, "qr_reader_decode_encoded");
+        if (!load.success) {
+            setError(result, load.error_msg);
+            return QR_READER_ERROR_DECODE;
+        }
+        return detect(detector, load.image, result);
+    });
+}
+
+void qr_reader_result_free(qr_reader_result* result) {
+    if (!result) return;
+    for (size_t i = 0; i < result->code_count; ++i) {
+        std::free(result->codes[i].data);
+    }
+    std::free(result->codes);
+    result->codes = nullptr;
+    result->code_count = 0;
+}
@@ -0,0 +1,102 @@
+#ifndef QR_READER_C_API_H
+#define QR_READER_C_API_H
+
+/* Тонкий C-интерфейс библиотеки qrreader для вызова из других языков и сервисов.
+ * Кадр передаётся указателем на буфер вызывающего с шагом строки и не копируется:
+ * буфер должен оставаться неизменным только на время вызова qr_reader_decode.
+ * Один детектор нельзя вызывать из нескольких потоков одновременно —
+ * заводите по детектору на поток. Исключения C++ через эту границу не проходят:
+ * любая внутренняя ошибка возвращается кодом QR_READER_ERROR_INTERNAL. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(QR_READER_SHARED)
+#  ifdef QR_READER_BUILDING_LIBRARY
+#    define QR_READER_API __declspec(dllexport)
+#  else
+#    define QR_READER_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define QR_READER_API __attribute__((visibility("default")))
+#else
+#  define QR_READER_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct qr_reader_detector qr_reader_detector;
+
+typedef enum {
+    QR_READER_PIXEL_GRAY8 = 0,
+    QR_READER_PIXEL_BGR24 = 1,
+    QR_READER_PIXEL_BGRA32 = 2
+} qr_reader_pixel_format;
+
+/* Коды возврата qr_reader_decode*: неотрицательные — детекция выполнена */
+enum {
+    QR_READER_NOT_FOUND = 0,
+    QR_READER_FOUND = 1,
+    QR_READER_ERROR_INVALID_ARGUMENT = -1,
+    QR_READER_ERROR_DECODE = -2,     /* сжатые байты не удалось декодировать */
+    QR_READER_ERROR_INTERNAL = -3
+};
+
+/* Уровень журнала библиотеки (stderr/stdout процесса); по умолчанию QR_READER_LOG_WARNING */
+typedef enum {
+    QR_READER_LOG_DEBUG = 0,
+    QR_READER_LOG_INFO = 1,
+    QR_READER_LOG_WARNING = 2,
+    QR_READER_LOG_ERROR = 3,
+    QR_READER_LOG_OFF = 4
+} qr_reader_log_level;
+
+typedef struct {
+    char* data;                      /* UTF-8 с завершающим нулём */
+    size_t data_size;                /* без завершающего нуля; данные могут содержать нули */
+    double confidence;               /* 0..1 */
+    int32_t bounding_box[8];         /* x0, y0, ..., x3, y3 в координатах кадра */
+} qr_reader_code;
+
+typedef struct {
+    qr_reader_code* codes;           /* самый уверенный код — первым */
+    size_t code_count;
+    char error_message[128];
+} qr_reader_result;
+
+QR_READER_API const char* qr_reader_version(void);
+
+/* Глобально для процесса; действует и на уже созданные детекторы.
+ * Возвращает QR_READER_ERROR_INVALID_ARGUMENT для неизвестного уровня, иначе 0 */
+QR_READER_API int qr_reader_set_log_level(qr_reader_log_level level);
+
+/* Побочный эффект: если уровень журнала ещё не задан через qr_reader_set_log_level, первый
+ * вызов переводит общий для процесса Logger на QR_READER_LOG_WARNING. Хосту, который сам
+ * пишет через Logger из qrreader, стоит выбрать уровень явно до первого qr_reader_create. */
+QR_READER_API qr_reader_detector* qr_reader_create(void);
+QR_READER_API void qr_reader_destroy(qr_reader_detector* detector);
+
+/* Каскад предобработки при неудаче на исходном кадре; включён по умолчанию */
+QR_READER_API void qr_reader_set_preprocessing(qr_reader_detector* detector, int enabled);
+/* Поиск всех кодов кадра; выключен по умолчанию */
+QR_READER_API void qr_reader_set_multi(qr_reader_detector* detector, int enabled);
+
+/* Кадр из памяти вызывающего: stride — байт на строку (не меньше width * байт на пиксель).
+ * result заполняется всегда и освобождается qr_reader_result_free. */
+QR_READER_API int qr_reader_decode(qr_reader_detector* detector, const uint8_t* pixels,
+                                   int width, int height, size_t stride,
+                                   qr_reader_pixel_format format, qr_reader_result* result);
+
+/* Сжатое изображение (PNG, JPEG, ...) целиком в памяти */
+QR_READER_API int qr_reader_decode_encoded(qr_reader_detector* detector, const uint8_t* data, size_t size,
+                                           qr_reader_result* result);
+
+QR_READER_API void qr_reader_result_free(qr_reader_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QR_READER_C_API_H */
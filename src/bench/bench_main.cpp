@@ -0,0 +1,36 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "qr_reader_config.h"
+#include "benchmarks.h"
+#include "../utils/logger.h"
+
+int main(int argc, char** argv) {
+    const std::map<std::string, int (*)(const std::vector<std::string>&)> benchmarks = {
+        {"binarize", runBinarizeBenchmark},
+        {"fused", runFusedBenchmark},
+#ifdef QR_READER_LINUX
+        {"loadgen", runLoadgenBenchmark},
+#endif
+        {"multi", runMultiCodeBenchmark},
+        {"pyramid", runPyramidBenchmark},
+        {"suite", runSuiteBenchmark},
+        {"tracking", runTrackingBenchmark},
+    };
+
+    if (argc < 2 || benchmarks.find(argv[1]) == benchmarks.end()) {
+        std::cerr << "Usage: qr_bench <benchmark> [options]" << std::endl;
+        std::cerr << "Benchmarks:" << std::endl;
+        for (const auto& entry : benchmarks) {
+            std::cerr << "  " << entry.first << std::endl;
+        }
+        return 1;
+    }
+
+    // Логирование на каждом кадре искажает замеры
+    Logger::setLogLevel(Logger::WARNING);
+
+    std::vector<std::string> args(argv + 2, argv + argc);
+    return benchmarks.at(argv[1])(args);
+}
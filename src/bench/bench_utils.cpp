@@ -0,0 +1,111 @@
+#include "bench_utils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace bench {
+
+cv::Mat renderQRCode(const std::string& payload, int module_px) {
+    cv::Mat modules;
+    cv::QRCodeEncoder::create()->encode(payload, modules);
+    if (modules.empty()) {
+        return modules;
+    }
+
+    // Энкодер не гарантирует ширину тихой зоны — добавляем стандартные 4 модуля
+    const int QUIET_ZONE = 4;
+    cv::copyMakeBorder(modules, modules, QUIET_ZONE, QUIET_ZONE, QUIET_ZONE, QUIET_ZONE,
+                       cv::BORDER_CONSTANT, cv::Scalar(255));
+
+    cv::Mat code;
+    cv::resize(modules, code, cv::Size(), module_px, module_px, cv::INTER_NEAREST);
+    return code;
+}
+
+cv::Mat renderCodeSheet(const std::vector<std::string>& payloads, int module_px,
+                        std::vector<cv::Rect>& rects) {
+    rects.clear();
+
+    std::vector<cv::Mat> codes;
+    int cell = 0;
+    for (const auto& payload : payloads) {
+        codes.push_back(renderQRCode(payload, module_px));
+        cell = std::max(cell, std::max(codes.back().cols, codes.back().rows));
+    }
+
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(codes.size()))));
+    int rows = (static_cast<int>(codes.size()) + columns - 1) / std::max(columns, 1);
+    int gap = cell / 2;
+
+    cv::Mat sheet(rows * (cell + gap) + gap, columns * (cell + gap) + gap, CV_8UC1, cv::Scalar(255));
+    for (size_t i = 0; i < codes.size(); ++i) {
+        int col = static_cast<int>(i) % columns;
+        int row = static_cast<int>(i) / columns;
+        cv::Rect rect(gap + col * (cell + gap), gap + row * (cell + gap), codes[i].cols, codes[i].rows);
+        codes[i].copyTo(sheet(rect));
+        rects.push_back(rect);
+    }
+
+    cv::Mat color;
+    cv::cvtColor(sheet, color, cv::COLOR_GRAY2BGR);
+    return color;
+}
+
+cv::Mat renderDocumentPage(const std::string& payload, cv::Size page_size,
+                           double code_fraction, cv::RNG& rng) {
+    cv::Mat page(page_size, CV_8UC3, cv::Scalar(245, 245, 245));
+
+    // Имитация текста: короткие тёмные штрихи построчно
+    int line_height = std::max(page_size.height / 80, 8);
+    for (int y = line_height * 2; y < page_size.height - line_height * 2; y += line_height * 2) {
+        int x = line_height * 2;
+        while (x < page_size.width - line_height * 4) {
+            int word = rng.uniform(line_height, line_height * 5);
+            cv::rectangle(page, cv::Rect(x, y, word, line_height), cv::Scalar(60, 60, 60), -1);
+            x += word + line_height;
+        }
+    }
+
+    cv::Mat code = renderQRCode(payload, 1);
+    double code_side = std::sqrt(code_fraction * page_size.area());
+    int module_px = std::max(1, static_cast<int>(code_side / code.cols));
+    code = renderQRCode(payload, module_px);
+
+    int x = rng.uniform(0, std::max(1, page_size.width - code.cols));
+    int y = rng.uniform(0, std::max(1, page_size.height - code.rows));
+    cv::Mat code_color;
+    cv::cvtColor(code, code_color, cv::COLOR_GRAY2BGR);
+    code_color.copyTo(page(cv::Rect(x, y, code.cols, code.rows)));
+
+    return page;
+}
+
+std::vector<std::string> getArgList(const std::vector<std::string>& args, const std::string& name) {
+    std::vector<std::string> values;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] != name) continue;
+        for (size_t j = i + 1; j < args.size() && args[j].rfind("--", 0) != 0; ++j) {
+            values.push_back(args[j]);
+        }
+        break;
+    }
+    return values;
+}
+
+std::string getArgValue(const std::vector<std::string>& args, const std::string& name,
+                        const std::string& default_value) {
+    for (size_t i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] == name) {
+            return args[i + 1];
+        }
+    }
+    return default_value;
+}
+
+double percentile(std::vector<double> values, double q) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(q * values.size()));
+    return values[std::min(std::max<size_t>(rank, 1), values.size()) - 1];
+}
+
+} // namespace bench
@@ -0,0 +1,54 @@
+#ifndef QR_READER_BENCH_UTILS_H
+#define QR_READER_BENCH_UTILS_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../utils/arg_parser.h"
+
+namespace bench {
+
+// Чёрно-белый QR-код с тихой зоной, module_px пикселей на модуль
+cv::Mat renderQRCode(const std::string& payload, int module_px);
+
+// Лист с несколькими кодами, расставленными по сетке; rects получает их положения
+cv::Mat renderCodeSheet(const std::vector<std::string>& payloads, int module_px,
+                        std::vector<cv::Rect>& rects);
+
+// Документ большого формата со «строками текста» и одним кодом в случайном месте;
+// code_fraction — доля площади страницы, занимаемая кодом
+cv::Mat renderDocumentPage(const std::string& payload, cv::Size page_size,
+                           double code_fraction, cv::RNG& rng);
+
+// Значения, идущие после name до следующего аргумента с префиксом "--"
+std::vector<std::string> getArgList(const std::vector<std::string>& args, const std::string& name);
+
+std::string getArgValue(const std::vector<std::string>& args, const std::string& name,
+                        const std::string& default_value);
+
+// Числовое значение аргумента с проверкой диапазона; false — значение неверно, причина в журнале
+template <typename T>
+bool getIntArg(const std::vector<std::string>& args, const std::string& name, const std::string& default_value,
+               long long min_value, long long max_value, T& out) {
+    return cli::parseIntArg(name, getArgValue(args, name, default_value).c_str(), min_value, max_value, out);
+}
+
+inline bool getDoubleArg(const std::vector<std::string>& args, const std::string& name,
+                         const std::string& default_value, double min_value, double max_value, double& out) {
+    return cli::parseDoubleArg(name, getArgValue(args, name, default_value).c_str(), min_value, max_value, out);
+}
+
+// Перцентиль по ближайшему рангу, q в [0, 1]; пустая выборка даёт 0
+double percentile(std::vector<double> values, double q);
+
+template <typename Fn>
+double measureMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace bench
+
+#endif // QR_READER_BENCH_UTILS_H
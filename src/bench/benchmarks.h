@@ -0,0 +1,17 @@
+#ifndef QR_READER_BENCHMARKS_H
+#define QR_READER_BENCHMARKS_H
+
+#include <string>
+#include <vector>
+
+// Каждый бенчмарк получает аргументы командной строки после своего имени
+// и возвращает код завершения процесса.
+int runMultiCodeBenchmark(const std::vector<std::string>& args);
+int runPyramidBenchmark(const std::vector<std::string>& args);
+int runTrackingBenchmark(const std::vector<std::string>& args);
+int runFusedBenchmark(const std::vector<std::string>& args);
+int runBinarizeBenchmark(const std::vector<std::string>& args);
+int runSuiteBenchmark(const std::vector<std::string>& args);
+int runLoadgenBenchmark(const std::vector<std::string>& args);
+
+#endif // QR_READER_BENCHMARKS_H
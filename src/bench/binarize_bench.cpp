@@ -0,0 +1,136 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "../core/qr_detector.h"
+#include "../io/image_loader.h"
+#include "../processors/image_processor.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct Mode {
+    std::string name;
+    ImageProcessor::BinarizationMethod method;
+    std::vector<std::string> stages;
+};
+
+// Код на фоне с градиентом освещения, тенью и бликом
+cv::Mat renderUnevenLighting(const std::string& payload, cv::RNG& rng) {
+    cv::Mat code = bench::renderQRCode(payload, 6);
+    cv::Mat canvas(800, 800, CV_8UC1, cv::Scalar(210));
+    int x = rng.uniform(0, canvas.cols - code.cols);
+    int y = rng.uniform(0, canvas.rows - code.rows);
+    code.copyTo(canvas(cv::Rect(x, y, code.cols, code.rows)));
+
+    cv::Mat lighting(canvas.size(), CV_32FC1);
+    double low = rng.uniform(0.15, 0.4);
+    double high = rng.uniform(1.1, 1.4);
+    cv::Point shadow(rng.uniform(0, canvas.cols), rng.uniform(0, canvas.rows));
+    cv::Point glare(rng.uniform(0, canvas.cols), rng.uniform(0, canvas.rows));
+    double shadow_radius = rng.uniform(120.0, 260.0);
+    double glare_radius = rng.uniform(60.0, 160.0);
+
+    for (int r = 0; r < lighting.rows; ++r) {
+        float* row = lighting.ptr<float>(r);
+        for (int c = 0; c < lighting.cols; ++c) {
+            double gain = low + (high - low) * c / lighting.cols;
+            double ds = std::hypot(c - shadow.x, r - shadow.y) / shadow_radius;
+            double dg = std::hypot(c - glare.x, r - glare.y) / glare_radius;
+            gain *= 1.0 - 0.6 * std::exp(-ds * ds);
+            gain += 0.9 * std::exp(-dg * dg);
+            row[c] = static_cast<float>(gain);
+        }
+    }
+
+    cv::Mat lit;
+    canvas.convertTo(lit, CV_32F);
+    lit = lit.mul(lighting);
+    lit.convertTo(canvas, CV_8U);
+
+    cv::Mat color;
+    cv::cvtColor(canvas, color, cv::COLOR_GRAY2BGR);
+    return color;
+}
+
+} // namespace
+
+// Полнота, время и число попыток каскада для глобального и локальных порогов.
+// Без --images генерируются кадры с градиентом освещения, тенью и бликом.
+int runBinarizeBenchmark(const std::vector<std::string>& args) {
+    std::vector<std::string> paths = bench::getArgList(args, "--images");
+
+    std::vector<cv::Mat> images;
+    std::vector<std::string> expected;
+
+    if (paths.empty()) {
+        int count = 0;
+        if (!bench::getIntArg(args, "--count", "40", 1, 100000, count)) {
+            return 1;
+        }
+        cv::RNG rng(2024);
+        for (int i = 0; i < count; ++i) {
+            std::string payload = "BIN-" + std::to_string(500000 + i);
+            images.push_back(renderUnevenLighting(payload, rng));
+            expected.push_back(payload);
+        }
+    } else {
+        for (const auto& path : paths) {
+            auto loaded = ImageLoader::loadFromFile(path);
+            if (!loaded.success) continue;
+            images.push_back(loaded.image);
+            expected.push_back("");
+        }
+    }
+
+    if (images.empty()) {
+        std::cerr << "No images to benchmark" << std::endl;
+        return 1;
+    }
+
+    const std::vector<Mode> modes = {
+        {"otsu", ImageProcessor::BINARIZE_OTSU, {"raw", "enhance"}},
+        {"mean", ImageProcessor::BINARIZE_MEAN, {"raw", "enhance"}},
+        {"sauvola", ImageProcessor::BINARIZE_SAUVOLA, {"raw", "enhance"}},
+        {"cascade", ImageProcessor::BINARIZE_OTSU, {}},
+    };
+
+    ImageProcessor::BinarizationMethod previous = ImageProcessor::getBinarizationMethod();
+    double count = static_cast<double>(images.size());
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark=binarize images=" << images.size() << std::endl;
+
+    for (const auto& mode : modes) {
+        ImageProcessor::setBinarizationMethod(mode.method);
+
+        QRDetector detector;
+        detector.setRetainProcessedImage(false);
+        if (!mode.stages.empty()) {
+            detector.getPreprocessingCascade().setOrder(mode.stages);
+        }
+
+        double total_ms = 0.0;
+        int correct = 0;
+        for (size_t i = 0; i < images.size(); ++i) {
+            QRDetector::DetectionResult result;
+            total_ms += bench::measureMs([&] { result = detector.detectFromImage(images[i]); });
+            if (result.success && (expected[i].empty() || expected[i] == result.data)) {
+                correct++;
+            }
+        }
+
+        int attempts = 0;
+        for (const auto& stage : detector.getPreprocessingCascade().getStats()) {
+            attempts += stage.attempts;
+        }
+
+        std::cout << "mode=" << mode.name
+                  << " recall=" << correct / count
+                  << " ms_per_image=" << total_ms / count
+                  << " attempts_per_image=" << attempts / count << std::endl;
+    }
+
+    ImageProcessor::setBinarizationMethod(previous);
+    return 0;
+}
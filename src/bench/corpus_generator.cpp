@@ -0,0 +1,148 @@
+#include "corpus_generator.h"
+#include "bench_utils.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace bench {
+
+namespace {
+
+const char* MANIFEST_FILE_NAME = "manifest.tsv";
+
+CorpusSample renderSample(int index, const CorpusConfig& config, cv::RNG& rng) {
+    CorpusSample sample;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%06d", index);
+    sample.file = std::string("sample_") + name + ".png";
+    sample.payload = std::string("CORPUS-") + name;
+
+    sample.module_px = rng.uniform(config.min_module_px, config.max_module_px + 1);
+    sample.rotation_deg = rng.uniform(-config.max_rotation_deg, config.max_rotation_deg);
+    sample.blur_sigma = rng.uniform(0.0, config.max_blur_sigma);
+    sample.noise_stddev = rng.uniform(0.0, config.max_noise_stddev);
+    sample.perspective = rng.uniform(0.0, config.max_perspective);
+    sample.lighting = rng.uniform(0.0, config.max_lighting);
+
+    cv::Mat code = renderQRCode(sample.payload, sample.module_px);
+    int side = code.cols * 3 / 2;
+    cv::Mat canvas(side, side, CV_8UC1, cv::Scalar(255));
+    code.copyTo(canvas(cv::Rect((side - code.cols) / 2, (side - code.rows) / 2, code.cols, code.rows)));
+
+    // Поворот и перспектива одним преобразованием: углы кадра поворачиваются вокруг центра
+    // и смещаются на случайную долю стороны
+    cv::Point2f center(side / 2.0f, side / 2.0f);
+    cv::Point2f src[4] = {{0.0f, 0.0f}, {static_cast<float>(side), 0.0f},
+                          {static_cast<float>(side), static_cast<float>(side)}, {0.0f, static_cast<float>(side)}};
+    cv::Point2f dst[4];
+    double angle = sample.rotation_deg * CV_PI / 180.0;
+    double jitter = sample.perspective * side;
+    for (int i = 0; i < 4; ++i) {
+        cv::Point2f offset = src[i] - center;
+        dst[i].x = static_cast<float>(center.x + offset.x * std::cos(angle) - offset.y * std::sin(angle) +
+                                      rng.uniform(-jitter, jitter));
+        dst[i].y = static_cast<float>(center.y + offset.x * std::sin(angle) + offset.y * std::cos(angle) +
+                                      rng.uniform(-jitter, jitter));
+    }
+    cv::Mat warped;
+    cv::warpPerspective(canvas, warped, cv::getPerspectiveTransform(src, dst), canvas.size(),
+                        cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(255));
+
+    // Линейный градиент освещения в случайном направлении
+    if (sample.lighting > 0.0) {
+        double direction = rng.uniform(0.0, 2.0 * CV_PI);
+        double dx = std::cos(direction);
+        double dy = std::sin(direction);
+        for (int y = 0; y < warped.rows; ++y) {
+            uchar* row = warped.ptr<uchar>(y);
+            for (int x = 0; x < warped.cols; ++x) {
+                double t = 0.5 + ((x - center.x) * dx + (y - center.y) * dy) / side;
+                double gain = 1.0 - sample.lighting * std::min(std::max(t, 0.0), 1.0);
+                row[x] = cv::saturate_cast<uchar>(row[x] * gain);
+            }
+        }
+    }
+
+    if (sample.blur_sigma > 0.1) {
+        cv::GaussianBlur(warped, warped, cv::Size(0, 0), sample.blur_sigma);
+    }
+
+    if (sample.noise_stddev > 0.5) {
+        cv::Mat noise(warped.size(), CV_16SC1);
+        rng.fill(noise, cv::RNG::NORMAL, 0.0, sample.noise_stddev);
+        cv::Mat noisy;
+        warped.convertTo(noisy, CV_16S);
+        noisy += noise;
+        noisy.convertTo(warped, CV_8U);
+    }
+
+    cv::cvtColor(warped, sample.image, cv::COLOR_GRAY2BGR);
+    return sample;
+}
+
+} // namespace
+
+std::vector<CorpusSample> generateCorpus(const CorpusConfig& config) {
+    std::vector<CorpusSample> samples;
+    samples.reserve(config.count);
+
+    cv::RNG rng(config.seed);
+    for (int i = 0; i < config.count; ++i) {
+        samples.push_back(renderSample(i, config, rng));
+    }
+    return samples;
+}
+
+bool writeCorpus(const std::vector<CorpusSample>& samples, const std::string& directory) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        return false;
+    }
+
+    std::ofstream manifest(std::filesystem::path(directory) / MANIFEST_FILE_NAME);
+    if (!manifest.is_open()) {
+        return false;
+    }
+
+    manifest << "file\tpayload\tmodule_px\trotation_deg\tblur_sigma\tnoise_stddev\tperspective\tlighting\n";
+    for (const auto& sample : samples) {
+        if (!cv::imwrite((std::filesystem::path(directory) / sample.file).string(), sample.image)) {
+            return false;
+        }
+        manifest << sample.file << '\t' << sample.payload << '\t' << sample.module_px << '\t'
+                 << sample.rotation_deg << '\t' << sample.blur_sigma << '\t' << sample.noise_stddev << '\t'
+                 << sample.perspective << '\t' << sample.lighting << '\n';
+    }
+
+    return manifest.good();
+}
+
+std::vector<CorpusSample> loadCorpus(const std::string& directory) {
+    std::vector<CorpusSample> samples;
+
+    std::ifstream manifest(std::filesystem::path(directory) / MANIFEST_FILE_NAME);
+    std::string line;
+    std::getline(manifest, line);   // заголовок
+
+    while (std::getline(manifest, line)) {
+        std::istringstream fields(line);
+        CorpusSample sample;
+        std::getline(fields, sample.file, '\t');
+        std::getline(fields, sample.payload, '\t');
+        fields >> sample.module_px >> sample.rotation_deg >> sample.blur_sigma >> sample.noise_stddev
+               >> sample.perspective >> sample.lighting;
+        if (sample.file.empty()) continue;
+
+        sample.image = cv::imread((std::filesystem::path(directory) / sample.file).string());
+        if (sample.image.empty()) continue;
+        samples.push_back(std::move(sample));
+    }
+
+    return samples;
+}
+
+} // namespace bench
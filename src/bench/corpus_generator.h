@@ -0,0 +1,45 @@
+#ifndef QR_READER_CORPUS_GENERATOR_H
+#define QR_READER_CORPUS_GENERATOR_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Параметры синтетического корпуса: каждое искажение выбирается равномерно
+// в [0, max] (размер модуля — в [min, max]) детерминированно от seed
+struct CorpusConfig {
+    int count = 200;
+    int min_module_px = 2;
+    int max_module_px = 8;
+    double max_rotation_deg = 30.0;
+    double max_blur_sigma = 1.5;
+    double max_noise_stddev = 12.0;
+    double max_perspective = 0.08;      // смещение углов, доля стороны кадра
+    double max_lighting = 0.5;          // глубина градиента освещения, 0..1
+    uint64_t seed = 1;
+};
+
+struct CorpusSample {
+    std::string file;                   // имя файла в каталоге корпуса
+    std::string payload;
+    cv::Mat image;
+    int module_px = 0;
+    double rotation_deg = 0.0;
+    double blur_sigma = 0.0;
+    double noise_stddev = 0.0;
+    double perspective = 0.0;
+    double lighting = 0.0;
+};
+
+std::vector<CorpusSample> generateCorpus(const CorpusConfig& config);
+
+// PNG-файлы и manifest.tsv с payload и параметрами искажений
+bool writeCorpus(const std::vector<CorpusSample>& samples, const std::string& directory);
+std::vector<CorpusSample> loadCorpus(const std::string& directory);
+
+} // namespace bench
+
+#endif // QR_READER_CORPUS_GENERATOR_H
@@ -0,0 +1,101 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "../io/image_loader.h"
+#include "../processors/fused_enhancer.h"
+#include "../processors/image_processor.h"
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Число несовпадающих пикселей; при разном размере — все пиксели эталона
+int countMismatches(const cv::Mat& reference, const cv::Mat& fused) {
+    if (reference.size() != fused.size() || reference.type() != fused.type()) {
+        return static_cast<int>(reference.total());
+    }
+    return cv::countNonZero(reference != fused);
+}
+
+} // namespace
+
+// Эталонная цепочка enhanceForQRDetection против слитного ядра FusedEnhancer:
+// время на кадр и побитное совпадение результатов.
+int runFusedBenchmark(const std::vector<std::string>& args) {
+    int iterations = 0;
+    if (!bench::getIntArg(args, "--iterations", "10", 1, 1000000, iterations)) {
+        return 1;
+    }
+    std::vector<std::string> paths = bench::getArgList(args, "--images");
+
+    std::vector<cv::Mat> images;
+
+    if (paths.empty()) {
+        int pages = 0;
+        int width = 0;
+        int height = 0;
+        if (!bench::getIntArg(args, "--pages", "4", 1, 10000, pages) ||
+            !bench::getIntArg(args, "--width", "2480", 64, 32768, width) ||
+            !bench::getIntArg(args, "--height", "3508", 64, 32768, height)) {
+            return 1;
+        }
+
+        cv::RNG rng(4242);
+        for (int i = 0; i < pages; ++i) {
+            // Страница уже цветная (CV_8UC3)
+            images.push_back(bench::renderDocumentPage("PAGE-" + std::to_string(i), cv::Size(width, height),
+                                                       0.05, rng));
+        }
+        // Малый кадр проверяет ветку с увеличением до 600 пикселей
+        cv::Mat small;
+        cv::cvtColor(bench::renderQRCode("SMALL", 4), small, cv::COLOR_GRAY2BGR);
+        images.push_back(small);
+    } else {
+        for (const auto& path : paths) {
+            auto loaded = ImageLoader::loadFromFile(path);
+            if (loaded.success) images.push_back(loaded.image);
+        }
+    }
+
+    if (images.empty()) {
+        std::cerr << "No images to benchmark" << std::endl;
+        return 1;
+    }
+
+    bool previous = ImageProcessor::isFusedEnhancementEnabled();
+    ImageProcessor::setFusedEnhancement(false);
+
+    double reference_ms = 0.0;
+    double fused_ms = 0.0;
+    long long mismatched_pixels = 0;
+    int mismatched_images = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& image : images) {
+            cv::Mat reference;
+            cv::Mat fused;
+            reference_ms += bench::measureMs([&] { reference = ImageProcessor::enhanceForQRDetection(image); });
+            fused_ms += bench::measureMs([&] { fused = FusedEnhancer::enhance(image); });
+
+            if (it == 0) {
+                int mismatches = countMismatches(reference, fused);
+                mismatched_pixels += mismatches;
+                if (mismatches > 0) mismatched_images++;
+            }
+        }
+    }
+
+    ImageProcessor::setFusedEnhancement(previous);
+
+    double calls = static_cast<double>(images.size()) * iterations;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark=fused images=" << images.size() << " iterations=" << iterations << std::endl;
+    std::cout << "reference_ms=" << reference_ms / calls << std::endl;
+    std::cout << "fused_ms=" << fused_ms / calls << std::endl;
+    std::cout << "speedup=" << (fused_ms > 0.0 ? reference_ms / fused_ms : 0.0) << std::endl;
+    std::cout << "identical=" << (mismatched_images == 0 ? "true" : "false")
+              << " mismatched_images=" << mismatched_images
+              << " mismatched_pixels=" << mismatched_pixels << std::endl;
+
+    return mismatched_images == 0 ? 0 : 2;
+}
@@ -0,0 +1,165 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "../io/image_loader.h"
+#include "../processors/image_processor.h"
+#include "../service/decode_client.h"
+#include "../service/decode_server.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+struct ClientStats {
+    std::vector<double> latencies_ms;
+    int errors = 0;
+    int not_found = 0;
+};
+
+void runClient(const std::string& endpoint, const std::vector<uchar>& encoded, const cv::Mat& gray,
+               std::atomic<int>& remaining, ClientStats& stats) {
+    DecodeClient client;
+    if (!client.connect(endpoint)) {
+        stats.errors++;
+        return;
+    }
+
+    while (remaining.fetch_sub(1) > 0) {
+        DecodeClient::Response response;
+        double ms = bench::measureMs([&] {
+            response = gray.empty() ? client.decodeEncoded(encoded.data(), encoded.size())
+                                    : client.decodeGray(gray);
+        });
+
+        if (!response.success) {
+            stats.errors++;
+            if (!client.connect(endpoint)) return;
+            continue;
+        }
+        if (response.status == decode_protocol::STATUS_NOT_FOUND) {
+            stats.not_found++;
+        } else if (response.status != decode_protocol::STATUS_DECODED) {
+            stats.errors++;
+        }
+        stats.latencies_ms.push_back(ms);
+    }
+}
+
+} // namespace
+
+// Генератор нагрузки для DecodeServer: N соединений шлют запросы без пауз,
+// на выходе — QPS и перцентили задержки со стороны клиента.
+// Без --connect сервер поднимается в этом же процессе на временном сокете.
+int runLoadgenBenchmark(const std::vector<std::string>& args) {
+    std::string endpoint = bench::getArgValue(args, "--connect", "");
+    std::string image_path = bench::getArgValue(args, "--image", "");
+    int concurrency = 0;
+    int requests = 0;
+    if (!bench::getIntArg(args, "--concurrency", "8", 1, 4096, concurrency) ||
+        !bench::getIntArg(args, "--requests", "2000", 1, 100000000, requests)) {
+        return 1;
+    }
+    bool send_gray = std::find(args.begin(), args.end(), "--gray") != args.end();
+
+    std::vector<uchar> encoded;
+    if (image_path.empty()) {
+        cv::imencode(".png", bench::renderQRCode("LOADGEN-000001", 6), encoded);
+    } else {
+        std::ifstream file(image_path, std::ios::binary);
+        encoded.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    cv::Mat gray;
+    if (send_gray) {
+        auto loaded = ImageLoader::loadFromBuffer(encoded, image_path);
+        if (!loaded.success) {
+            std::cerr << "Cannot decode image for --gray: " << loaded.error_msg << std::endl;
+            return 1;
+        }
+        gray = ImageProcessor::convertToGrayscale(loaded.image);
+    }
+
+    if (encoded.empty()) {
+        std::cerr << "No image to send" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<DecodeServer> server;
+    std::thread server_thread;
+    if (endpoint.empty()) {
+        DecodeServer::Config config;
+        config.endpoint = "unix:/tmp/qr_bench_loadgen_" + std::to_string(::getpid()) + ".sock";
+        if (!bench::getIntArg(args, "--workers", "0", 0, 1024, config.num_workers) ||
+            !bench::getIntArg(args, "--max-batch", "16", 1, 4096, config.max_batch) ||
+            !bench::getIntArg(args, "--window-us", "500", 0, 1000000, config.batch_window_us)) {
+            return 1;
+        }
+        endpoint = config.endpoint;
+
+        server.reset(new DecodeServer(config));
+        server_thread = std::thread([&server] { server->run(); });
+
+        // Ждём, пока сервер начнёт принимать соединения
+        DecodeClient probe;
+        for (int attempt = 0; attempt < 200 && !probe.connect(endpoint); ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!probe.isConnected()) {
+            std::cerr << "In-process server did not start: " << probe.getError() << std::endl;
+            server->stop();
+            server_thread.join();
+            return 1;
+        }
+        // Пробное соединение иначе держало бы читающий поток сервера весь замер
+        probe.close();
+    }
+
+    std::atomic<int> remaining{requests};
+    std::vector<ClientStats> client_stats(concurrency);
+    std::vector<std::thread> clients;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < concurrency; ++i) {
+        clients.emplace_back(runClient, std::cref(endpoint), std::cref(encoded), std::cref(gray),
+                             std::ref(remaining), std::ref(client_stats[i]));
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> latencies;
+    int errors = 0;
+    int not_found = 0;
+    for (const auto& stats : client_stats) {
+        latencies.insert(latencies.end(), stats.latencies_ms.begin(), stats.latencies_ms.end());
+        errors += stats.errors;
+        not_found += stats.not_found;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark=loadgen endpoint=" << endpoint << " concurrency=" << concurrency
+              << " payload=" << (send_gray ? "gray" : "encoded") << std::endl;
+    std::cout << "requests=" << latencies.size() << " errors=" << errors << " not_found=" << not_found
+              << " seconds=" << seconds << std::endl;
+    std::cout << "qps=" << (seconds > 0.0 ? latencies.size() / seconds : 0.0) << std::endl;
+    std::cout << "latency_p50_ms=" << bench::percentile(latencies, 0.50)
+              << " latency_p90_ms=" << bench::percentile(latencies, 0.90)
+              << " latency_p99_ms=" << bench::percentile(latencies, 0.99)
+              << " latency_max_ms=" << bench::percentile(latencies, 1.0) << std::endl;
+
+    if (server) {
+        server->stop();
+        server_thread.join();
+        auto stats = server->getStats();
+        std::cout << "server_batches=" << stats.batches << " avg_batch_size=" << stats.avg_batch_size
+                  << " server_latency_avg_ms=" << stats.avg_latency_ms << std::endl;
+    }
+
+    return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "../core/qr_detector.h"
+#include <iomanip>
+#include <iostream>
+
+// Сравнение одного мульти-прохода по листу с N одиночными вызовами по вырезкам —
+// так сейчас обрабатываются листы с несколькими этикетками.
+int runMultiCodeBenchmark(const std::vector<std::string>& args) {
+    int num_codes = 0;
+    int iterations = 0;
+    int module_px = 0;
+    if (!bench::getIntArg(args, "--codes", "8", 1, 1000, num_codes) ||
+        !bench::getIntArg(args, "--iterations", "20", 1, 1000000, iterations) ||
+        !bench::getIntArg(args, "--module", "4", 1, 64, module_px)) {
+        return 1;
+    }
+
+    std::vector<std::string> payloads;
+    for (int i = 0; i < num_codes; ++i) {
+        payloads.push_back("SHIP-LABEL-" + std::to_string(100000 + i));
+    }
+
+    std::vector<cv::Rect> rects;
+    cv::Mat sheet = bench::renderCodeSheet(payloads, module_px, rects);
+
+    QRDetector multi_detector;
+    multi_detector.setPreprocessingEnabled(false);
+    multi_detector.setRetainProcessedImage(false);
+    multi_detector.setMultipleQRDetection(true);
+
+    QRDetector single_detector;
+    single_detector.setPreprocessingEnabled(false);
+    single_detector.setRetainProcessedImage(false);
+
+    double multi_ms = 0.0;
+    double single_ms = 0.0;
+    size_t multi_found = 0;
+    size_t single_found = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        QRDetector::DetectionResult multi_result;
+        multi_ms += bench::measureMs([&] { multi_result = multi_detector.detectFromImage(sheet); });
+        multi_found += multi_result.codes.size();
+
+        single_ms += bench::measureMs([&] {
+            for (const auto& rect : rects) {
+                if (single_detector.detectFromImage(sheet(rect)).success) {
+                    single_found++;
+                }
+            }
+        });
+    }
+
+    double expected = static_cast<double>(num_codes) * iterations;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark=multi_code codes=" << num_codes
+              << " sheet=" << sheet.cols << "x" << sheet.rows
+              << " iterations=" << iterations << std::endl;
+    std::cout << "multi_pass_ms=" << multi_ms / iterations
+              << " recall=" << multi_found / expected << std::endl;
+    std::cout << "single_crops_ms=" << single_ms / iterations
+              << " recall=" << single_found / expected << std::endl;
+    std::cout << "speedup=" << (multi_ms > 0.0 ? single_ms / multi_ms : 0.0) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "../core/qr_detector.h"
+#include "../io/image_loader.h"
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct ModeStats {
+    double total_ms = 0.0;
+    int found = 0;
+    int correct = 0;
+};
+
+void runMode(QRDetector& detector, const std::vector<cv::Mat>& images,
+             const std::vector<std::string>& expected, int iterations, ModeStats& stats) {
+    for (int it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < images.size(); ++i) {
+            QRDetector::DetectionResult result;
+            stats.total_ms += bench::measureMs([&] { result = detector.detectFromImage(images[i]); });
+            if (it != 0 || !result.success) continue;
+            stats.found++;
+            if (expected[i].empty() || expected[i] == result.data) {
+                stats.correct++;
+            }
+        }
+    }
+}
+
+} // namespace
+
+// Латентность и полнота с пирамидальной локализацией и без неё.
+// Без --images генерируются страницы, где код занимает малую долю площади.
+int runPyramidBenchmark(const std::vector<std::string>& args) {
+    int iterations = 0;
+    int max_side = 0;
+    if (!bench::getIntArg(args, "--iterations", "5", 1, 1000000, iterations) ||
+        !bench::getIntArg(args, "--max-side", "1024", 64, 32768, max_side)) {
+        return 1;
+    }
+    std::vector<std::string> paths = bench::getArgList(args, "--images");
+
+    std::vector<cv::Mat> images;
+    std::vector<std::string> expected;
+
+    if (paths.empty()) {
+        int pages = 0;
+        int width = 0;
+        int height = 0;
+        double fraction = 0.0;
+        if (!bench::getIntArg(args, "--pages", "10", 1, 10000, pages) ||
+            !bench::getIntArg(args, "--width", "4960", 64, 32768, width) ||
+            !bench::getIntArg(args, "--height", "7016", 64, 32768, height) ||
+            !bench::getDoubleArg(args, "--code-fraction", "0.02", 0.0001, 1.0, fraction)) {
+            return 1;
+        }
+
+        cv::RNG rng(12345);
+        for (int i = 0; i < pages; ++i) {
+            std::string payload = "INVOICE-" + std::to_string(700000 + i);
+            images.push_back(bench::renderDocumentPage(payload, cv::Size(width, height), fraction, rng));
+            expected.push_back(payload);
+        }
+    } else {
+        for (const auto& path : paths) {
+            auto loaded = ImageLoader::loadFromFile(path);
+            if (!loaded.success) continue;
+            images.push_back(loaded.image);
+            expected.push_back("");
+        }
+    }
+
+    if (images.empty()) {
+        std::cerr << "No images to benchmark" << std::endl;
+        return 1;
+    }
+
+    QRDetector full_detector;
+    full_detector.setPreprocessingEnabled(false);
+    full_detector.setRetainProcessedImage(false);
+
+    QRDetector pyramid_detector;
+    pyramid_detector.setPreprocessingEnabled(false);
+    pyramid_detector.setRetainProcessedImage(false);
+    pyramid_detector.setPyramidLocalization(true, max_side);
+
+    ModeStats full_stats;
+    ModeStats pyramid_stats;
+    runMode(full_detector, images, expected, iterations, full_stats);
+    runMode(pyramid_detector, images, expected, iterations, pyramid_stats);
+
+    double calls = static_cast<double>(images.size()) * iterations;
+    double count = static_cast<double>(images.size());
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark=pyramid images=" << images.size()
+              << " iterations=" << iterations << " max_side=" << max_side << std::endl;
+    std::cout << "full_frame_ms=" << full_stats.total_ms / calls
+              << " recall=" << full_stats.correct / count << std::endl;
+    std::cout << "pyramid_ms=" << pyramid_stats.total_ms / calls
+              << " recall=" << pyramid_stats.correct / count << std::endl;
+    std::cout << "speedup=" << (pyramid_stats.total_ms > 0.0 ? full_stats.total_ms / pyramid_stats.total_ms : 0.0)
+              << std::endl;
+
+    return 0;
+}
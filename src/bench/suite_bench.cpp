@@ -0,0 +1,151 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "corpus_generator.h"
+#include "../core/qr_detector.h"
+#include "../io/image_loader.h"
+#include "../io/result_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace {
+
+const std::vector<std::string> STAGES = {"load", "preprocess", "detect", "confidence", "write"};
+
+void writeStageJson(std::ostream& out, const std::vector<double>& samples) {
+    double total = 0.0;
+    for (double v : samples) total += v;
+    out << "{\"mean_ms\": " << (samples.empty() ? 0.0 : total / samples.size())
+        << ", \"p50_ms\": " << bench::percentile(samples, 0.50)
+        << ", \"p99_ms\": " << bench::percentile(samples, 0.99)
+        << ", \"total_ms\": " << total << "}";
+}
+
+} // namespace
+
+// Сквозной замер на синтетическом корпусе: время каждой стадии (загрузка, предобработка,
+// детекция, уверенность, запись), изображения в секунду, p50/p99 и полнота.
+// Вывод — JSON, который можно сравнивать между сборками.
+int runSuiteBenchmark(const std::vector<std::string>& args) {
+    bench::CorpusConfig corpus_config;
+    if (!bench::getIntArg(args, "--count", "200", 1, 1000000, corpus_config.count) ||
+        !bench::getIntArg(args, "--seed", "1", 0, std::numeric_limits<long long>::max(), corpus_config.seed) ||
+        !bench::getIntArg(args, "--min-module", "2", 1, 64, corpus_config.min_module_px) ||
+        !bench::getIntArg(args, "--max-module", "8", 1, 64, corpus_config.max_module_px) ||
+        !bench::getDoubleArg(args, "--max-rotation", "30", 0.0, 180.0, corpus_config.max_rotation_deg) ||
+        !bench::getDoubleArg(args, "--max-blur", "1.5", 0.0, 50.0, corpus_config.max_blur_sigma) ||
+        !bench::getDoubleArg(args, "--max-noise", "12", 0.0, 255.0, corpus_config.max_noise_stddev) ||
+        !bench::getDoubleArg(args, "--max-perspective", "0.08", 0.0, 0.5, corpus_config.max_perspective) ||
+        !bench::getDoubleArg(args, "--max-lighting", "0.5", 0.0, 1.0, corpus_config.max_lighting)) {
+        return 1;
+    }
+    if (corpus_config.min_module_px > corpus_config.max_module_px) {
+        std::cerr << "--min-module must not exceed --max-module" << std::endl;
+        return 1;
+    }
+
+    std::string corpus_dir = bench::getArgValue(args, "--corpus", "");
+    std::string write_corpus_dir = bench::getArgValue(args, "--write-corpus", "");
+    std::string output_path = bench::getArgValue(args, "--output", "");
+    std::string results_dir = bench::getArgValue(args, "--results-dir",
+                                                 (std::filesystem::temp_directory_path() / "qr_bench_suite").string());
+    bool preprocessing = bench::getArgValue(args, "--preprocessing", "on") != "off";
+
+    std::vector<bench::CorpusSample> corpus = corpus_dir.empty() ? bench::generateCorpus(corpus_config)
+                                                                 : bench::loadCorpus(corpus_dir);
+    if (corpus.empty()) {
+        std::cerr << "Corpus is empty" << std::endl;
+        return 1;
+    }
+
+    if (!write_corpus_dir.empty() && !bench::writeCorpus(corpus, write_corpus_dir)) {
+        std::cerr << "Failed to write corpus to " << write_corpus_dir << std::endl;
+        return 1;
+    }
+
+    // Загрузка меряется от закодированных байтов, чтобы не зависеть от кэша ФС
+    std::vector<std::vector<uchar>> encoded(corpus.size());
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        cv::imencode(".png", corpus[i].image, encoded[i]);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(results_dir, ec);
+
+    QRDetector detector;
+    detector.setPreprocessingEnabled(preprocessing);
+    detector.setRetainProcessedImage(false);
+
+    std::map<std::string, std::vector<double>> stage_ms;
+    std::vector<double> latency_ms;
+    int found = 0;
+    int correct = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        ImageLoader::LoadResult loaded;
+        QRDetector::DetectionResult result;
+
+        double load_ms = bench::measureMs([&] {
+            loaded = ImageLoader::loadFromMemory(encoded[i].data(), encoded[i].size(), corpus[i].file);
+        });
+        if (!loaded.success) continue;
+
+        double detect_total_ms = bench::measureMs([&] { result = detector.detectFromImage(loaded.image); });
+
+        std::string result_path = (std::filesystem::path(results_dir) / (corpus[i].file + ".txt")).string();
+        double write_ms = bench::measureMs([&] { ResultWriter::saveToTextFile(result, result_path); });
+
+        stage_ms["load"].push_back(load_ms);
+        stage_ms["preprocess"].push_back(result.timings.preprocess_ms);
+        stage_ms["detect"].push_back(result.timings.detect_ms);
+        stage_ms["confidence"].push_back(result.timings.confidence_ms);
+        stage_ms["write"].push_back(write_ms);
+        latency_ms.push_back(load_ms + detect_total_ms + write_ms);
+
+        if (result.success) {
+            found++;
+            if (result.data == corpus[i].payload) correct++;
+        }
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+    json << "{\n";
+    json << "  \"benchmark\": \"suite\",\n";
+    json << "  \"images\": " << corpus.size() << ",\n";
+    json << "  \"seed\": " << corpus_config.seed << ",\n";
+    json << "  \"corpus\": \"" << (corpus_dir.empty() ? "generated" : corpus_dir) << "\",\n";
+    json << "  \"preprocessing\": " << (preprocessing ? "true" : "false") << ",\n";
+    json << "  \"elapsed_s\": " << elapsed_s << ",\n";
+    json << "  \"images_per_second\": " << (elapsed_s > 0.0 ? corpus.size() / elapsed_s : 0.0) << ",\n";
+    json << "  \"found\": " << found << ",\n";
+    json << "  \"recall\": " << static_cast<double>(correct) / corpus.size() << ",\n";
+    json << "  \"latency\": ";
+    writeStageJson(json, latency_ms);
+    json << ",\n  \"stages\": {\n";
+    for (size_t s = 0; s < STAGES.size(); ++s) {
+        json << "    \"" << STAGES[s] << "\": ";
+        writeStageJson(json, stage_ms[STAGES[s]]);
+        json << (s + 1 < STAGES.size() ? ",\n" : "\n");
+    }
+    json << "  }\n}\n";
+
+    if (output_path.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(output_path);
+        out << json.str();
+        if (!out.good()) {
+            std::cerr << "Failed to write " << output_path << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "benchmarks.h"
+#include "bench_utils.h"
+#include "../core/qr_detector.h"
+#include "../core/qr_tracker.h"
+#include "../io/frame_source.h"
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Конвейер: код едет слева направо, периодически лента стоит, каждая
+// посылка несёт новый код
+std::vector<cv::Mat> renderConveyorClip(int frames, int speed_px, int package_every) {
+    std::vector<cv::Mat> clip;
+    const cv::Size frame_size(1280, 720);
+
+    cv::Mat code;
+    int package = -1;
+    int x = 0;
+
+    for (int i = 0; i < frames; ++i) {
+        if (i / package_every != package) {
+            package = i / package_every;
+            code = bench::renderQRCode("PKG-" + std::to_string(900000 + package), 5);
+            cv::cvtColor(code, code, cv::COLOR_GRAY2BGR);
+            x = 0;
+        }
+
+        cv::Mat frame(frame_size, CV_8UC3, cv::Scalar(90, 90, 90));
+        int y = (frame_size.height - code.rows) / 2;
+        if (x + code.cols <= frame_size.width) {
+            code.copyTo(frame(cv::Rect(x, y, code.cols, code.rows)));
+        }
+        clip.push_back(frame);
+
+        // Каждую вторую половину цикла посылки лента стоит на сканере
+        bool paused = (i % package_every) > package_every / 2;
+        if (!paused) {
+            x += speed_px;
+        }
+    }
+
+    return clip;
+}
+
+} // namespace
+
+// CPU на кадр при полном поиске на каждом кадре против сопровождения QRTracker
+int runTrackingBenchmark(const std::vector<std::string>& args) {
+    std::string video = bench::getArgValue(args, "--video", "");
+    int max_frames = 0;
+    if (!bench::getIntArg(args, "--frames", "300", 1, 1000000, max_frames)) {
+        return 1;
+    }
+
+    std::vector<cv::Mat> clip;
+    if (!video.empty()) {
+        FrameSource capture(video);
+        if (!capture.open()) {
+            std::cerr << "Failed to open clip: " << video << std::endl;
+            return 1;
+        }
+        cv::Mat frame;
+        while (static_cast<int>(clip.size()) < max_frames && capture.read(frame)) {
+            clip.push_back(frame.clone());
+        }
+    } else {
+        int speed = 0;
+        int package_every = 0;
+        if (!bench::getIntArg(args, "--speed", "12", 0, 1000, speed) ||
+            !bench::getIntArg(args, "--package-every", "60", 1, 1000000, package_every)) {
+            return 1;
+        }
+        clip = renderConveyorClip(max_frames, speed, package_every);
+    }
+
+    if (clip.empty()) {
+        std::cerr << "Clip has no frames" << std::endl;
+        return 1;
+    }
+
+    QRDetector full_detector;
+    full_detector.setPreprocessingEnabled(false);
+    full_detector.setRetainProcessedImage(false);
+
+    QRDetector tracked_detector;
+    tracked_detector.setPreprocessingEnabled(false);
+    tracked_detector.setRetainProcessedImage(false);
+    QRTracker tracker(tracked_detector);
+
+    double full_ms = 0.0;
+    double tracked_ms = 0.0;
+    int full_decoded = 0;
+    int tracked_decoded = 0;
+    int agreement = 0;
+
+    for (const auto& frame : clip) {
+        QRDetector::DetectionResult full_result;
+        QRDetector::DetectionResult tracked_result;
+        full_ms += bench::measureMs([&] { full_result = full_detector.detectFromImage(frame); });
+        tracked_ms += bench::measureMs([&] { tracked_result = tracker.track(frame); });
+
+        if (full_result.success) full_decoded++;
+        if (tracked_result.success) tracked_decoded++;
+        if (full_result.success == tracked_result.success &&
+            (!full_result.success || full_result.data == tracked_result.data)) {
+            agreement++;
+        }
+    }
+
+    const auto& stats = tracker.getStats();
+    double frames = static_cast<double>(clip.size());
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark=tracking frames=" << clip.size()
+              << " source=" << (video.empty() ? "synthetic" : video) << std::endl;
+    std::cout << "full_search_ms_per_frame=" << full_ms / frames
+              << " decoded_frames=" << full_decoded << std::endl;
+    std::cout << "tracking_ms_per_frame=" << tracked_ms / frames
+              << " decoded_frames=" << tracked_decoded << std::endl;
+    std::cout << "tracker_full=" << stats.full_searches
+              << " tracker_window=" << stats.window_searches
+              << " tracker_reused=" << stats.reused_results
+              << " tracker_misses=" << stats.misses << std::endl;
+    std::cout << "agreement=" << agreement / frames << std::endl;
+    std::cout << "cpu_reduction=" << (tracked_ms > 0.0 ? full_ms / tracked_ms : 0.0) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,383 @@
+#include "batch_processor.h"
+#include "../io/image_loader.h"
+#include "../io/result_writer.h"
+#include "../processors/image_processor.h"
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// Координаты с уменьшенного кадра переводим в систему исходного файла
+void scaleGeometry(QRDetector::DetectionResult& result, int factor) {
+    for (auto& point : result.bounding_box) {
+        point *= factor;
+    }
+    for (auto& code : result.codes) {
+        for (auto& point : code.bounding_box) {
+            point *= factor;
+        }
+    }
+}
+
+} // namespace
+
+double BatchProcessor::BatchStats::getSuccessRate() const {
+    if (total_detections == 0) return 0.0;
+    return static_cast<double>(successful_detections) / total_detections;
+}
+
+double BatchProcessor::BatchStats::getThroughput() const {
+    if (elapsed_seconds <= 0.0) return 0.0;
+    return total_files / elapsed_seconds;
+}
+
+BatchProcessor::BatchProcessor() : BatchProcessor(Config()) {
+}
+
+BatchProcessor::BatchProcessor(const Config& config) : config_(config) {
+    if (config_.cache_enabled) {
+        // Кэш живёт дольше одного пакета: повторные прогоны попадают в него
+        cache_ = std::make_unique<ResultCache>(config_.cache);
+    }
+    if (config_.debug_capture.enabled) {
+        // Один фоновый кодировщик и общий бюджет на все потоки детекции
+        debug_capture_ = std::make_unique<DebugCapture>(config_.debug_capture);
+    }
+}
+
+BatchProcessor::BatchStats BatchProcessor::process(const std::vector<std::string>& paths) {
+    ScopedTimer timer("BatchProcessor::process");
+
+    BatchStats stats;
+    stats.total_files = static_cast<int>(paths.size());
+    if (paths.empty()) {
+        QR_LOG_WARNING("Batch is empty, nothing to process");
+        return stats;
+    }
+
+    int num_workers = resolveWorkerCount(paths.size());
+    int num_decoders = resolveDecoderCount(num_workers);
+    stats.workers = num_workers;
+    stats.decoders = num_decoders;
+    QR_LOG_INFO("Starting pipeline: " + std::to_string(num_decoders) + " decoders, " +
+                std::to_string(num_workers) + " detectors, queue capacity " +
+                std::to_string(config_.queue_capacity));
+
+    // Параллелим по изображениям, поэтому внутренний пул OpenCV только мешает
+    int previous_cv_threads = cv::getNumThreads();
+    if (num_workers > 1) {
+        cv::setNumThreads(1);
+    }
+
+    if (cache_) {
+        // Метод бинаризации — глобальная настройка, поэтому отпечаток снимаем на каждый пакет
+        config_fingerprint_ = computeConfigFingerprint();
+    }
+
+    auto loader_before = ImageLoader::getStats();
+    auto start = std::chrono::steady_clock::now();
+
+    BoundedQueue<PendingFile> file_queue(config_.queue_capacity);
+    BoundedQueue<PendingImage> image_queue(config_.queue_capacity);
+    BoundedQueue<PendingResult> result_queue(config_.queue_capacity);
+
+    std::atomic<int> loaded_files{0};
+    std::vector<WorkerStats> worker_stats(num_workers);
+
+    std::thread reader(&BatchProcessor::readStage, this, std::cref(paths), std::ref(file_queue));
+
+    std::vector<std::thread> decoders;
+    for (int i = 0; i < num_decoders; ++i) {
+        decoders.emplace_back(&BatchProcessor::decodeStage, this,
+                              std::ref(file_queue), std::ref(image_queue), std::ref(loaded_files));
+    }
+
+    std::vector<std::thread> detectors;
+    for (int i = 0; i < num_workers; ++i) {
+        detectors.emplace_back(&BatchProcessor::detectStage, this,
+                               std::ref(image_queue), std::ref(result_queue), std::ref(worker_stats[i]));
+    }
+
+    std::thread writer(&BatchProcessor::writeStage, this, std::ref(result_queue), std::ref(stats));
+
+    // Закрываем очереди по цепочке: каждая стадия завершается, когда опустела предыдущая
+    reader.join();
+    file_queue.close();
+    for (auto& decoder : decoders) decoder.join();
+    image_queue.close();
+    for (auto& detector : detectors) detector.join();
+    result_queue.close();
+    writer.join();
+
+    stats.elapsed_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    cv::setNumThreads(previous_cv_threads);
+
+    stats.loaded_files = loaded_files.load();
+
+    auto loader_after = ImageLoader::getStats();
+    stats.bytes_read = loader_after.bytes_read - loader_before.bytes_read;
+    stats.pooled_decodes = loader_after.pooled_decodes - loader_before.pooled_decodes;
+    stats.decode_allocations = loader_after.decode_allocations - loader_before.decode_allocations;
+    stats.reduced_decodes = loader_after.reduced_decodes - loader_before.reduced_decodes;
+
+    PreprocessingCascade merged_cascade = createCascade();
+    for (const auto& ws : worker_stats) {
+        stats.total_detections += ws.total_detections + ws.cached_results;
+        stats.successful_detections += ws.successful_detections + ws.cached_successes;
+        stats.cached_results += ws.cached_results;
+        stats.full_resolution_retries += ws.full_resolution_retries;
+        merged_cascade.mergeStats(ws.stage_stats);
+        stats.gate_stats.merge(ws.gate_stats);
+    }
+    stats.stage_stats = merged_cascade.getStats();
+    if (cache_) {
+        stats.cache_stats = cache_->getStats();
+    }
+    if (debug_capture_) {
+        // Снимки пакета должны быть на диске к моменту возврата
+        debug_capture_->flush();
+        stats.capture_stats = debug_capture_->getStats();
+    }
+
+    return stats;
+}
+
+void BatchProcessor::readStage(const std::vector<std::string>& paths, BoundedQueue<PendingFile>& out) {
+    for (size_t index = 0; index < paths.size(); ++index) {
+        auto file = ImageLoader::readFile(paths[index]);
+        if (!file.success) {
+            QR_LOG_ERROR("Skipping " + paths[index] + ": " + file.error_msg);
+            continue;
+        }
+
+        if (!out.push({index, paths[index], std::move(file.mapping)})) break;
+    }
+}
+
+void BatchProcessor::decodeStage(BoundedQueue<PendingFile>& in, BoundedQueue<PendingImage>& out,
+                                 std::atomic<int>& loaded_files) {
+    PendingFile file;
+    while (in.pop(file)) {
+        PendingImage pending;
+        pending.index = file.index;
+        pending.path = file.path;
+
+        if (cache_ && !config_.cache_by_pixels) {
+            pending.cache_key = ResultCache::combineKey(
+                ResultCache::hashBytes(file.mapping->data(), file.mapping->size()), config_fingerprint_);
+            if (cache_->lookup(pending.cache_key, pending.cached_result)) {
+                // Попадание по байтам файла — даже imdecode не нужен
+                pending.from_cache = true;
+                loaded_files++;
+                if (!out.push(std::move(pending))) break;
+                continue;
+            }
+        }
+
+        auto load_result = ImageLoader::loadFromMemory(file.mapping->data(), file.mapping->size(),
+                                                       file.path, config_.decode);
+        if (load_result.success && load_result.reduction > 1) {
+            pending.reduction = load_result.reduction;
+            pending.mapping = file.mapping;
+        }
+        // Сжатые байты больше не нужны — снимаем отображение до того, как встанем в очередь
+        file.mapping.reset();
+
+        if (!load_result.success) {
+            QR_LOG_ERROR("Skipping " + file.path + ": " + load_result.error_msg);
+            continue;
+        }
+        loaded_files++;
+
+        if (cache_ && config_.cache_by_pixels) {
+            pending.cache_key = ResultCache::combineKey(ResultCache::hashImage(load_result.image),
+                                                       config_fingerprint_);
+            pending.from_cache = cache_->lookup(pending.cache_key, pending.cached_result);
+        }
+        if (!pending.from_cache) {
+            pending.image = load_result.image;
+        }
+
+        if (!out.push(std::move(pending))) break;
+    }
+}
+
+void BatchProcessor::detectStage(BoundedQueue<PendingImage>& in, BoundedQueue<PendingResult>& out,
+                                 WorkerStats& stats) {
+    // У каждого потока свой детектор: cv::QRCodeDetector нельзя вызывать конкурентно
+    QRDetector detector;
+    detector.setPreprocessingEnabled(config_.preprocessing_enabled);
+    detector.setMultipleQRDetection(config_.multiple_qr_enabled);
+    detector.setPyramidLocalization(config_.pyramid_localization);
+    detector.setGrayscaleProcessing(config_.decode.grayscale);
+    detector.getPreprocessingCascade() = createCascade();
+    detector.getQualityGate() = QualityGate(config_.quality_gate);
+    detector.setQualityGateEnabled(config_.quality_gate_enabled);
+    detector.setDebugCapture(debug_capture_.get());
+    // Кадр нужен писателю только для визуализации; иначе отпускаем его сразу
+    detector.setRetainProcessedImage(config_.save_results);
+
+    PendingImage pending;
+    while (in.pop(pending)) {
+        if (pending.from_cache) {
+            stats.cached_results++;
+            if (pending.cached_result.success) {
+                stats.cached_successes++;
+            }
+            if (!out.push({pending.index, pending.path, std::move(pending.cached_result)})) break;
+            continue;
+        }
+
+        auto detection = detector.detectFromImage(pending.image, pending.path);
+        pending.image.release();
+
+        if (pending.reduction > 1) {
+            if (detection.success) {
+                scaleGeometry(detection, pending.reduction);
+                // Уменьшенный кадр не совпадает с координатами исходного — не храним его
+                detection.processed_image.release();
+            } else if (pending.mapping) {
+                // Код не прочитался на уменьшенном кадре — единственный повтор в полном размере
+                ImageLoader::DecodeOptions full_options = config_.decode;
+                full_options.reduction = 1;
+                auto full_load = ImageLoader::loadFromMemory(pending.mapping->data(), pending.mapping->size(),
+                                                             pending.path, full_options);
+                if (full_load.success) {
+                    stats.full_resolution_retries++;
+                    detection = detector.detectFromImage(full_load.image, pending.path);
+                }
+            }
+            pending.mapping.reset();
+        }
+
+        if (cache_) {
+            cache_->insert(pending.cache_key, detection);
+        }
+
+        if (!out.push({pending.index, pending.path, std::move(detection)})) break;
+    }
+
+    // Повтор в полном размере — это та же картинка, а не новая детекция
+    stats.total_detections = detector.getTotalDetections() - stats.full_resolution_retries;
+    stats.successful_detections = detector.getSuccessfulDetections();
+    stats.stage_stats = detector.getPreprocessingCascade().getStats();
+    stats.gate_stats = detector.getQualityGate().getStats();
+}
+
+void BatchProcessor::writeStage(BoundedQueue<PendingResult>& in, BatchStats& stats) {
+    std::unique_ptr<ResultStreamWriter> writer;
+    if (!config_.results.path.empty()) {
+        writer.reset(new ResultStreamWriter(config_.results));
+        if (!writer->open()) {
+            writer.reset();
+        }
+    }
+
+    // Разметка и кодирование кадров не задерживают стадию вывода
+    std::unique_ptr<VisualizationRenderer> renderer;
+    if (config_.save_results) {
+        renderer.reset(new VisualizationRenderer(config_.visualization));
+    }
+
+    PendingResult pending;
+    while (in.pop(pending)) {
+        outputResult(pending, writer.get(), renderer.get());
+        pending.result = QRDetector::DetectionResult();
+    }
+
+    if (writer) {
+        writer->close();
+        stats.writer_stats = writer->getStats();
+    }
+    if (renderer) {
+        renderer->close();
+        stats.render_stats = renderer->getStats();
+    }
+}
+
+void BatchProcessor::outputResult(const PendingResult& pending, ResultStreamWriter* writer,
+                                  VisualizationRenderer* renderer) {
+    const QRDetector::DetectionResult& result = pending.result;
+
+    if (config_.print_results) {
+        ResultWriter::printToConsole(result);
+    }
+
+    // Поток результатов получает и неудачи — в нём видно, какие файлы не распознались
+    if (writer) {
+        writer->write(pending.path, result);
+    }
+
+    if (config_.save_results && result.success) {
+        // Имена файлов привязаны к индексу входа, а не к порядку завершения потоков
+        std::string suffix = std::to_string(pending.index + 1);
+        if (!writer) {
+            ResultWriter::saveToTextFile(result, config_.output_prefix + "_result_" + suffix + ".txt");
+        }
+        // Результаты из кэша приходят без кадра — визуализировать нечего
+        if (renderer && !result.processed_image.empty()) {
+            renderer->submit(result, config_.output_prefix + "_visualization_" + suffix);
+        }
+    }
+}
+
+PreprocessingCascade BatchProcessor::createCascade() const {
+    PreprocessingCascade cascade = PreprocessingCascade::createDefault();
+    if (!config_.cascade_stages.empty()) {
+        cascade.setOrder(config_.cascade_stages);
+    }
+    return cascade;
+}
+
+uint64_t BatchProcessor::computeConfigFingerprint() const {
+    // Всё, от чего зависит результат детекции; потоки, очереди и вывод сюда не входят
+    std::string description = "v1";
+    description += ";pre=" + std::to_string(config_.preprocessing_enabled);
+    description += ";multi=" + std::to_string(config_.multiple_qr_enabled);
+    description += ";pyramid=" + std::to_string(config_.pyramid_localization);
+    description += ";reduce=" + std::to_string(config_.decode.reduction);
+    description += ";gray=" + std::to_string(config_.decode.grayscale);
+    description += ";binarize=" + std::to_string(static_cast<int>(ImageProcessor::getBinarizationMethod()));
+
+    // Порядок по умолчанию берём из самого каскада: он меняется вместе с кодом
+    description += ";stages=";
+    if (config_.cascade_stages.empty()) {
+        PreprocessingCascade cascade = PreprocessingCascade::createDefault();
+        for (size_t i = 0; i < cascade.size(); ++i) {
+            description += cascade.getStageName(i) + ",";
+        }
+    } else {
+        for (const auto& stage : config_.cascade_stages) {
+            description += stage + ",";
+        }
+    }
+
+    description += ";gate=" + std::to_string(config_.quality_gate_enabled);
+    if (config_.quality_gate_enabled) {
+        const QualityGate::Config& gate = config_.quality_gate;
+        description += "," + std::to_string(gate.target_samples) + "," + std::to_string(gate.min_mean) +
+                       "," + std::to_string(gate.max_mean) + "," + std::to_string(gate.min_stddev) +
+                       "," + std::to_string(gate.edge_threshold) + "," + std::to_string(gate.min_edge_per_mille);
+    }
+
+    return ResultCache::hashString(description);
+}
+
+int BatchProcessor::resolveWorkerCount(size_t job_count) const {
+    int workers = config_.num_workers;
+    if (workers <= 0) {
+        workers = static_cast<int>(std::thread::hardware_concurrency());
+        if (workers <= 0) workers = 1;
+    }
+    return static_cast<int>(std::min<size_t>(workers, job_count));
+}
+
+int BatchProcessor::resolveDecoderCount(int workers) const {
+    if (config_.num_decoders > 0) return config_.num_decoders;
+    return std::max(1, workers / 2);
+}
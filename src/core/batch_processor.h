@@ -0,0 +1,132 @@
+#ifndef QR_READER_BATCH_PROCESSOR_H
+#define QR_READER_BATCH_PROCESSOR_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "qr_detector.h"
+#include "../io/debug_capture.h"
+#include "../io/image_loader.h"
+#include "../io/mapped_file.h"
+#include "../io/result_cache.h"
+#include "../io/result_stream_writer.h"
+#include "../io/visualization_renderer.h"
+#include "../utils/bounded_queue.h"
+
+// Потоковый конвейер: чтение -> imdecode -> детекция -> вывод.
+// Стадии связаны очередями ограниченной ёмкости, поэтому число изображений
+// в памяти не зависит от размера пакета.
+class BatchProcessor {
+public:
+    struct Config {
+        int num_workers = 0;            // потоки детекции, 0 = hardware_concurrency()
+        int num_decoders = 0;           // потоки imdecode, 0 = половина от num_workers
+        size_t queue_capacity = 8;      // ёмкость каждой межстадийной очереди
+        bool preprocessing_enabled = true;
+        bool multiple_qr_enabled = false;
+        bool pyramid_localization = false;
+        std::vector<std::string> cascade_stages;    // порядок стадий предобработки, пусто = по умолчанию
+        ImageLoader::DecodeOptions decode;  // уменьшенное/одноканальное декодирование
+        bool quality_gate_enabled = false;  // отсев пустых/размытых кадров до декодирования
+        QualityGate::Config quality_gate;
+        bool cache_enabled = false;
+        bool cache_by_pixels = false;   // ключ по декодированным пикселям, а не по байтам файла
+        ResultCache::Config cache;
+        bool print_results = true;
+        bool save_results = true;
+        std::string output_prefix = "qr";
+        // Непустой results.path: все результаты пишутся в один JSONL/CSV файл
+        // вместо отдельного .txt на каждое изображение
+        ResultStreamWriter::Config results;
+        // Визуализации рисуются и кодируются в фоновых потоках: формат, миниатюра, обрезка
+        VisualizationRenderer::Config visualization;
+        // Снимки неудачных кадров для разбора; выключено по умолчанию
+        DebugCapture::Config debug_capture;
+    };
+
+    struct BatchStats {
+        int total_files = 0;
+        int loaded_files = 0;
+        int total_detections = 0;
+        int successful_detections = 0;
+        int workers = 0;
+        int decoders = 0;
+        double elapsed_seconds = 0.0;
+        std::vector<PreprocessingCascade::StageStats> stage_stats;
+        int cached_results = 0;
+        ResultCache::CacheStats cache_stats;
+        int64_t bytes_read = 0;
+        int64_t pooled_decodes = 0;
+        int64_t decode_allocations = 0;
+        int64_t reduced_decodes = 0;
+        int full_resolution_retries = 0;
+        QualityGate::GateStats gate_stats;
+        ResultStreamWriter::WriterStats writer_stats;
+        DebugCapture::CaptureStats capture_stats;
+        VisualizationRenderer::RenderStats render_stats;
+
+        double getSuccessRate() const;
+        double getThroughput() const;
+    };
+
+    BatchProcessor();
+    explicit BatchProcessor(const Config& config);
+
+    BatchStats process(const std::vector<std::string>& paths);
+
+private:
+    struct PendingFile {
+        size_t index = 0;
+        std::string path;
+        std::shared_ptr<MappedFile> mapping;
+    };
+
+    struct PendingImage {
+        size_t index = 0;
+        std::string path;
+        cv::Mat image;
+        int reduction = 1;
+        // Сохраняется только при уменьшенном декодировании — для повтора в полном размере
+        std::shared_ptr<MappedFile> mapping;
+        uint64_t cache_key = 0;
+        bool from_cache = false;
+        QRDetector::DetectionResult cached_result;
+    };
+
+    struct PendingResult {
+        size_t index = 0;
+        std::string path;
+        QRDetector::DetectionResult result;
+    };
+
+    struct WorkerStats {
+        int total_detections = 0;
+        int successful_detections = 0;
+        int cached_results = 0;
+        int cached_successes = 0;
+        int full_resolution_retries = 0;
+        std::vector<PreprocessingCascade::StageStats> stage_stats;
+        QualityGate::GateStats gate_stats;
+    };
+
+    Config config_;
+    std::unique_ptr<ResultCache> cache_;
+    uint64_t config_fingerprint_ = 0;   // отпечаток настроек детектора в ключах кэша
+    std::unique_ptr<DebugCapture> debug_capture_;
+
+    void readStage(const std::vector<std::string>& paths, BoundedQueue<PendingFile>& out);
+    void decodeStage(BoundedQueue<PendingFile>& in, BoundedQueue<PendingImage>& out,
+                     std::atomic<int>& loaded_files);
+    void detectStage(BoundedQueue<PendingImage>& in, BoundedQueue<PendingResult>& out,
+                     WorkerStats& stats);
+    void writeStage(BoundedQueue<PendingResult>& in, BatchStats& stats);
+
+    void outputResult(const PendingResult& pending, ResultStreamWriter* writer, VisualizationRenderer* renderer);
+    PreprocessingCascade createCascade() const;
+    uint64_t computeConfigFingerprint() const;
+    int resolveWorkerCount(size_t job_count) const;
+    int resolveDecoderCount(int workers) const;
+};
+
+#endif // QR_READER_BATCH_PROCESSOR_H
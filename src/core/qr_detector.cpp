@@ -1,67 +1,183 @@
 #include "qr_detector.h"
 #include "../utils/logger.h"
+#include "../utils/profiler.h"
 #include "../processors/image_processor.h"
+#include "../processors/module_sampler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Один и тот же код, найденный в пересекающихся ROI или повторно на полном кадре:
+// совпадают и данные, и положение. Разные коды с одинаковым содержимым сохраняются
+bool isSameCode(const QRDetector::CodeResult& a, const QRDetector::CodeResult& b) {
+    if (a.data != b.data) return false;
+    if (a.bounding_box.empty() || b.bounding_box.empty()) return true;
+    return (cv::boundingRect(a.bounding_box) & cv::boundingRect(b.bounding_box)).area() > 0;
+}
+
+void appendUniqueCodes(std::vector<QRDetector::CodeResult>& into, std::vector<QRDetector::CodeResult>& from) {
+    for (auto& code : from) {
+        bool duplicate = std::any_of(into.begin(), into.end(),
+                                     [&](const QRDetector::CodeResult& known) { return isSameCode(known, code); });
+        if (!duplicate) {
+            into.push_back(std::move(code));
+        }
+    }
+}
+
+// Сортировка по уверенности и дублирование лучшего кода в поля одиночного результата
+void finalizeMultiResult(QRDetector::DetectionResult& result) {
+    if (result.codes.empty()) return;
+
+    std::stable_sort(result.codes.begin(), result.codes.end(),
+                     [](const QRDetector::CodeResult& a, const QRDetector::CodeResult& b) {
+                         return a.confidence > b.confidence;
+                     });
+    result.success = true;
+    result.data = result.codes.front().data;
+    result.bounding_box = result.codes.front().bounding_box;
+    result.confidence = result.codes.front().confidence;
+    result.error_message.clear();
+}
+
+} // namespace
 
 QRDetector::QRDetector() {
-    Logger::info("QRDetector initialized");
+    QR_LOG_INFO("QRDetector initialized");
 }
 
-QRDetector::DetectionResult QRDetector::detectFromImage(const cv::Mat& image) {
-    Logger::startOperation("QR detection from image");
+QRDetector::DetectionResult QRDetector::detectFromImage(const cv::Mat& image, const std::string& source) {
+    ScopedTimer timer("QRDetector::detectFromImage");
     total_detections_++;
 
     if (image.empty()) {
-        Logger::error("Cannot detect QR codes in empty image");
+        QR_LOG_ERROR("Cannot detect QR codes in empty image");
         return {false, "", {}, 0.0, cv::Mat(), "Empty input image"};
     }
 
-    cv::Mat processed_image = image.clone();
-
-    DetectionResult original_result = processDetection(processed_image);
-
-    if (!original_result.success && preprocessing_enabled_) {
-        Logger::debug("Trying with image enhancement...");
-        cv::Mat enhanced_image = ImageProcessor::enhanceForQRDetection(image);
-        DetectionResult enhanced_result = processDetection(enhanced_image);
-
-        if (enhanced_result.success) {
-            enhanced_result.processed_image = enhanced_image;
-            Logger::info("QR found after enhancement!");
-            successful_detections_++;
-            Logger::endOperation("QR detection from image");
-            return enhanced_result;
+    if (quality_gate_enabled_) {
+        QualityGate::Verdict verdict = quality_gate_.evaluate(image);
+        if (!verdict.passed) {
+            QR_LOG_DEBUG("Frame rejected by quality gate: " + QualityGate::getReasonName(verdict.reason));
+            DetectionResult rejected;
+            rejected.error_message = "Rejected by quality gate (" + QualityGate::getReasonName(verdict.reason) + ")";
+            rejected.detected_at = std::chrono::system_clock::now();
+            return rejected;
         }
+    }
 
-        cv::imwrite("debug_enhanced.png", enhanced_image);
+    // Детекция работает прямо по буферу вызывающего, без клонирования;
+    // стадии каскада пробуются по очереди до первого успеха
+    const cv::Mat input = grayscale_processing_ ? ImageProcessor::convertToGrayscale(image) : image;
+
+    auto decode_start = std::chrono::steady_clock::now();
+    DetectionResult result;
+    cv::Mat winning_image;
+    double prepare_ms = 0.0;
+    confidence_ms_ = 0.0;
+    int stage = cascade_.run(input, [&](const cv::Mat& candidate) {
+        result = processDetection(candidate);
+        return result.success;
+    }, preprocessing_enabled_, &winning_image, &prepare_ms);
+
+    double decode_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - decode_start).count();
+    result.timings.preprocess_ms = prepare_ms;
+    result.timings.confidence_ms = confidence_ms_;
+    result.timings.detect_ms = std::max(decode_ms - prepare_ms - confidence_ms_, 0.0);
+    result.detected_at = std::chrono::system_clock::now();
+
+    if (quality_gate_enabled_) {
+        quality_gate_.recordDecode(decode_ms, stage >= 0);
     }
 
-    if (original_result.success) {
+    if (stage >= 0) {
         successful_detections_++;
-        original_result.processed_image = processed_image;
-        Logger::info("QR detection successful: " + original_result.data);
+        result.preprocessing_stage = cascade_.getStageName(stage);
+        if (retain_processed_image_) {
+            result.processed_image = winning_image;
+        }
+        QR_LOG_INFO("QR detection successful (stage '" + result.preprocessing_stage + "'): " + result.data);
     } else {
-        Logger::warning("QR detection failed");
-        // Сохраняем оригинал для отладки
-        cv::imwrite("debug_original.png", processed_image);
+        QR_LOG_WARNING("QR detection failed");
+        if (result.error_message.empty()) {
+            result.error_message = "No QR code detected in image";
+        }
+        if (debug_capture_) {
+            debug_capture_->capture(image, source);
+        }
     }
 
-    Logger::endOperation("QR detection from image");
-    return original_result;
+    return result;
 }
 
-QRDetector::DetectionResult QRDetector::detectFromWebcam() {
-    Logger::info("Attempting QR detection from webcam");
-    return DetectionResult{false, "", {}, 0.0, cv::Mat(), "Webcam detection not implemented yet"};
+void QRDetector::warmUp() {
+    cv::Mat blank(64, 64, CV_8UC1, cv::Scalar(255));
+    try {
+        std::vector<cv::Point> points;
+        if (multiple_qr_enabled_) {
+            std::vector<std::string> decoded;
+            qr_detector_.detectAndDecodeMulti(blank, decoded, points);
+        } else {
+            qr_detector_.detectAndDecode(blank, points);
+        }
+    }
+    catch (const cv::Exception&) {
+        // Прогрев необязателен: настоящая ошибка проявится и будет записана на первом кадре
+    }
 }
 
 void QRDetector::setPreprocessingEnabled(bool enabled) {
     preprocessing_enabled_ = enabled;
-    Logger::debug("Preprocessing " + std::string(enabled ? "enabled" : "disabled"));
+    QR_LOG_DEBUG("Preprocessing " + std::string(enabled ? "enabled" : "disabled"));
 }
 
 void QRDetector::setMultipleQRDetection(bool enabled) {
     multiple_qr_enabled_ = enabled;
-    Logger::debug("Multiple QR detection " + std::string(enabled ? "enabled" : "disabled"));
+    QR_LOG_DEBUG("Multiple QR detection " + std::string(enabled ? "enabled" : "disabled"));
+}
+
+void QRDetector::setRetainProcessedImage(bool enabled) {
+    retain_processed_image_ = enabled;
+    QR_LOG_DEBUG("Processed image retention " + std::string(enabled ? "enabled" : "disabled"));
+}
+
+void QRDetector::setGrayscaleProcessing(bool enabled) {
+    grayscale_processing_ = enabled;
+    QR_LOG_DEBUG("Grayscale processing " + std::string(enabled ? "enabled" : "disabled"));
+}
+
+void QRDetector::setPyramidLocalization(bool enabled, int max_side) {
+    pyramid_localization_enabled_ = enabled;
+    localization_max_side_ = std::max(max_side, 64);
+    QR_LOG_DEBUG("Pyramid localization " + std::string(enabled ? "enabled" : "disabled") +
+                 " (max side " + std::to_string(localization_max_side_) + ")");
+}
+
+void QRDetector::setQualityGateEnabled(bool enabled) {
+    quality_gate_enabled_ = enabled;
+    QR_LOG_DEBUG("Quality gate " + std::string(enabled ? "enabled" : "disabled"));
+}
+
+QualityGate& QRDetector::getQualityGate() {
+    return quality_gate_;
+}
+
+const QualityGate& QRDetector::getQualityGate() const {
+    return quality_gate_;
+}
+
+void QRDetector::setDebugCapture(DebugCapture* capture) {
+    debug_capture_ = capture;
+}
+
+PreprocessingCascade& QRDetector::getPreprocessingCascade() {
+    return cascade_;
+}
+
+const PreprocessingCascade& QRDetector::getPreprocessingCascade() const {
+    return cascade_;
 }
 
 int QRDetector::getTotalDetections() const {
@@ -78,25 +194,156 @@ double QRDetector::getSuccessRate() const {
 }
 
 QRDetector::DetectionResult QRDetector::processDetection(const cv::Mat& image) {
+    if (pyramid_localization_enabled_ &&
+        std::max(image.cols, image.rows) > localization_max_side_) {
+        DetectionResult localized = processLocalizedDetection(image);
+        if (localized.success && !multiple_qr_enabled_) {
+            return localized;
+        }
+        if (localized.success) {
+            // Сколько кодов на кадре, локализация не знает: мелкие коды могут пропасть
+            // на уменьшенном уровне. Полный кадр проходим всегда, ROI лишь добавляют
+            // коды, которые в полном разрешении нашлись только вблизи
+            DetectionResult full = processMultiDetection(image);
+            appendUniqueCodes(localized.codes, full.codes);
+            finalizeMultiResult(localized);
+            return localized;
+        }
+        QR_LOG_DEBUG("Pyramid localization missed, falling back to full frame");
+    }
+
+    return processFullFrameDetection(image);
+}
+
+QRDetector::DetectionResult QRDetector::processFullFrameDetection(const cv::Mat& image) {
+    if (multiple_qr_enabled_) {
+        return processMultiDetection(image);
+    }
+    return processSingleDetection(image);
+}
+
+QRDetector::DetectionResult QRDetector::processLocalizedDetection(const cv::Mat& image) {
+    DetectionResult result;
+    result.error_message = "No QR code candidates found on pyramid level";
+
+    std::vector<cv::Rect> candidates = localizeCandidates(image);
+    QR_LOG_DEBUG("Pyramid localization candidates: " + std::to_string(candidates.size()));
+
+    for (const auto& roi : candidates) {
+        // ROI — view исходного буфера, декодирование идёт в полном разрешении
+        DetectionResult roi_result = processFullFrameDetection(image(roi));
+        if (!roi_result.success) {
+            result.error_message = roi_result.error_message;
+            continue;
+        }
+
+        for (auto& point : roi_result.bounding_box) {
+            point += roi.tl();
+        }
+        for (auto& code : roi_result.codes) {
+            for (auto& point : code.bounding_box) {
+                point += roi.tl();
+            }
+        }
+
+        if (!multiple_qr_enabled_) {
+            return roi_result;
+        }
+
+        // Соседние ROI могут перекрываться — не дублируем один и тот же код
+        appendUniqueCodes(result.codes, roi_result.codes);
+    }
+
+    finalizeMultiResult(result);
+    return result;
+}
+
+std::vector<cv::Rect> QRDetector::localizeCandidates(const cv::Mat& image) {
+    std::vector<cv::Rect> candidates;
+
+    try {
+        cv::Mat level = image;
+        double scale = 1.0;
+        while (std::max(level.cols, level.rows) > localization_max_side_) {
+            cv::Mat next;
+            cv::pyrDown(level, next);
+            level = next;
+            scale *= 2.0;
+        }
+
+        std::vector<cv::Point2f> points;
+        if (!qr_detector_.detectMulti(level, points) || points.size() < 4) {
+            points.clear();
+            if (!qr_detector_.detect(level, points)) {
+                return candidates;
+            }
+        }
+
+        const cv::Rect frame(0, 0, image.cols, image.rows);
+        for (size_t i = 0; i + 4 <= points.size(); i += 4) {
+            std::vector<cv::Point> quad;
+            for (size_t j = i; j < i + 4; ++j) {
+                quad.emplace_back(cvRound(points[j].x * scale), cvRound(points[j].y * scale));
+            }
+
+            // Запас на тихую зону и погрешность координат после уменьшения
+            cv::Rect box = cv::boundingRect(quad);
+            int margin = std::max(static_cast<int>(std::max(box.width, box.height) * 0.25),
+                                  static_cast<int>(scale * 4));
+            box = cv::Rect(box.x - margin, box.y - margin,
+                           box.width + 2 * margin, box.height + 2 * margin) & frame;
+
+            if (box.area() == 0) continue;
+            candidates.push_back(box);
+        }
+
+        // Пересекающиеся кандидаты объединяем, чтобы не декодировать дважды. Объединение
+        // может задеть ещё один прямоугольник, поэтому повторяем до неподвижной точки
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < candidates.size() && !merged; ++i) {
+                for (size_t j = i + 1; j < candidates.size(); ++j) {
+                    if ((candidates[i] & candidates[j]).area() > 0) {
+                        candidates[i] |= candidates[j];
+                        candidates.erase(candidates.begin() + j);
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    catch (const cv::Exception& e) {
+        QR_LOG_ERROR("OpenCV exception during localization: " + std::string(e.what()));
+        candidates.clear();
+    }
+
+    return candidates;
+}
+
+QRDetector::DetectionResult QRDetector::processSingleDetection(const cv::Mat& image) {
     DetectionResult result;
 
     try {
         std::vector<cv::Point> points;
-        std::string data = qr_detector_.detectAndDecode(image, points);
+        // Карта модулей строится детектором при декодировании — для оценки уверенности она бесплатна
+        cv::Mat straight_qrcode;
+        std::string data = qr_detector_.detectAndDecode(image, points, straight_qrcode);
 
-        Logger::debug("QR detection attempted, data length: " + std::to_string(data.length()));
-        Logger::debug("Found points: " + std::to_string(points.size()));
+        QR_LOG_DEBUG("QR detection attempted, data length: " + std::to_string(data.length()));
+        QR_LOG_DEBUG("Found points: " + std::to_string(points.size()));
 
         if (!data.empty()) {
-            Logger::debug("Raw QR data: " + data);
+            QR_LOG_DEBUG("Raw QR data: " + data);
         }
 
         if (!data.empty() && validateQRData(data)) {
             result.success = true;
             result.data = data;
             result.bounding_box = points;
-            result.confidence = calculateConfidence(points, image);
-            Logger::debug("QR validation passed");
+            result.confidence = calculateConfidence(points, image, straight_qrcode);
+            QR_LOG_DEBUG("QR validation passed");
         } else {
             result.success = false;
             if (data.empty()) {
@@ -109,7 +356,52 @@ QRDetector::DetectionResult QRDetector::processDetection(const cv::Mat& image) {
     catch (const cv::Exception& e) {
         result.success = false;
         result.error_message = "OpenCV error: " + std::string(e.what());
-        Logger::error("OpenCV exception: " + std::string(e.what()));
+        QR_LOG_ERROR("OpenCV exception: " + std::string(e.what()));
+    }
+
+    return result;
+}
+
+QRDetector::DetectionResult QRDetector::processMultiDetection(const cv::Mat& image) {
+    DetectionResult result;
+
+    try {
+        // Один проход поиска finder-паттернов по всему кадру для всех кодов сразу
+        std::vector<std::string> decoded;
+        std::vector<cv::Point> points;
+        std::vector<cv::Mat> straight_qrcodes;
+        qr_detector_.detectAndDecodeMulti(image, decoded, points, straight_qrcodes);
+
+        QR_LOG_DEBUG("Multi QR detection attempted, candidates: " + std::to_string(decoded.size()));
+
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            if (decoded[i].empty() || !validateQRData(decoded[i])) continue;
+            if (points.size() < (i + 1) * 4) break;
+
+            CodeResult code;
+            code.data = decoded[i];
+            code.bounding_box.assign(points.begin() + i * 4, points.begin() + (i + 1) * 4);
+            code.confidence = calculateConfidence(code.bounding_box, image,
+                                                  i < straight_qrcodes.size() ? straight_qrcodes[i] : cv::Mat());
+            result.codes.push_back(std::move(code));
+        }
+
+        if (!result.codes.empty()) {
+            finalizeMultiResult(result);
+            QR_LOG_DEBUG("Decoded QR codes: " + std::to_string(result.codes.size()));
+        } else {
+            result.success = false;
+            if (decoded.empty()) {
+                result.error_message = "No QR code detected in image";
+            } else {
+                result.error_message = "QR codes found but data validation failed";
+            }
+        }
+    }
+    catch (const cv::Exception& e) {
+        result.success = false;
+        result.error_message = "OpenCV error: " + std::string(e.what());
+        QR_LOG_ERROR("OpenCV exception: " + std::string(e.what()));
     }
 
     return result;
@@ -129,26 +421,27 @@ bool QRDetector::validateQRData(const std::string& data) {
     return true;
 }
 
-double QRDetector::calculateConfidence(const std::vector<cv::Point>& bbox, const cv::Mat& image) {
+double QRDetector::calculateConfidence(const std::vector<cv::Point>& bbox, const cv::Mat& image,
+                                       const cv::Mat& straight_qrcode) {
     if (bbox.size() != 4) return 0.0;
 
+    auto start = std::chrono::steady_clock::now();
     double confidence = 0.0;
 
-    double qr_area = cv::contourArea(bbox);
-    double image_area = image.cols * image.rows;
-    double size_ratio = qr_area / image_area;
-
-    if (size_ratio > 0.1 && size_ratio < 0.8) {
-        confidence += 0.4;
-    } else if (size_ratio > 0.05 && size_ratio < 0.9) {
-        confidence += 0.2;
-    }
+    // Качество самих модулей в области кода вместо лапласиана по всему кадру
+    ModuleSampler::ModuleScore modules = ModuleSampler::measure(image, bbox, straight_qrcode);
+    if (modules.valid) {
+        if (modules.contrast > 0.4 && modules.separation > 3.0) {
+            confidence += 0.4;
+        } else if (modules.contrast > 0.2 && modules.separation > 1.5) {
+            confidence += 0.2;
+        }
 
-    double quality_score = ImageProcessor::calculateQualityScore(image);
-    if (quality_score > 100) {
-        confidence += 0.3;
-    } else if (quality_score > 50) {
-        confidence += 0.15;
+        if (modules.timing_regularity > 0.95) {
+            confidence += 0.3;
+        } else if (modules.timing_regularity > 0.8) {
+            confidence += 0.15;
+        }
     }
 
     std::vector<double> sides;
@@ -172,5 +465,6 @@ double QRDetector::calculateConfidence(const std::vector<cv::Point>& bbox, const
         confidence += 0.15;
     }
 
+    confidence_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     return std::min(confidence, 1.0);
 }
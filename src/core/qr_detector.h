@@ -2,27 +2,78 @@
 #define QR_READER_QR_DETECTOR_H
 
 #include <opencv2/opencv.hpp>
+#include <chrono>
 #include <string>
 #include <vector>
+#include "../processors/preprocessing_cascade.h"
+#include "../processors/quality_gate.h"
+#include "../io/debug_capture.h"
 
 class QRDetector {
 public:
+    struct CodeResult {
+        std::string data;
+        std::vector<cv::Point> bounding_box;
+        double confidence = 0.0;
+    };
+
     struct DetectionResult {
         bool success = false;
         std::string data;
         std::vector<cv::Point> bounding_box;
         double confidence = 0.0;
+        // Заголовок cv::Mat, разделяющий буфер вызывающего (или улучшенного) изображения —
+        // пиксели не копируются. Пуст, если сохранение кадра отключено.
         cv::Mat processed_image;
         std::string error_message;
+        // Все распознанные коды кадра при включённой мульти-детекции;
+        // data/bounding_box/confidence выше дублируют самый уверенный из них
+        std::vector<CodeResult> codes;
+        // Стадия каскада предобработки, на которой код был найден
+        std::string preprocessing_stage;
+
+        // Время этапов внутри detectFromImage, мс
+        struct Timings {
+            double preprocess_ms = 0.0;     // стратегии каскада
+            double detect_ms = 0.0;         // поиск и декодирование по всем попыткам
+            double confidence_ms = 0.0;     // оценка уверенности
+        };
+        Timings timings;
+        // Момент завершения детекции; пустое значение — неизвестен (результат из кэша)
+        std::chrono::system_clock::time_point detected_at;
     };
 
     QRDetector();
 
-    DetectionResult detectFromImage(const cv::Mat& image);
-    DetectionResult detectFromWebcam();
+    // source — имя файла или кадра; используется только в именах отладочных снимков
+    // Детектор работает только с готовыми кадрами; захват с камеры — FrameSource и StreamDecoder
+    DetectionResult detectFromImage(const cv::Mat& image, const std::string& source = std::string());
+    // Первый вызов OpenCV выделяет внутренние буферы — резидентные режимы платят за это при
+    // запуске. Пустой кадр идёт мимо журнала, счётчиков, quality gate и отладочных снимков
+    void warmUp();
 
     void setPreprocessingEnabled(bool enabled);
     void setMultipleQRDetection(bool enabled);
+    void setRetainProcessedImage(bool enabled);
+    // Цветной вход один раз переводится в оттенки серого, дальше — только один канал
+    void setGrayscaleProcessing(bool enabled);
+    // Грубая локализация на уменьшенном уровне пирамиды, затем декодирование
+    // только найденных областей в исходном разрешении. При мульти-детекции
+    // полный кадр проверяется всё равно, ROI только дополняют его коды
+    void setPyramidLocalization(bool enabled, int max_side = 1024);
+
+    // Предварительный отсев пустых, пересвеченных и размытых кадров до декодирования
+    void setQualityGateEnabled(bool enabled);
+    QualityGate& getQualityGate();
+    const QualityGate& getQualityGate() const;
+
+    // Сохранение неудачных кадров; nullptr (по умолчанию) — ничего не пишется.
+    // Объект принадлежит вызывающему и может быть общим для нескольких детекторов
+    void setDebugCapture(DebugCapture* capture);
+
+    // Стадии предобработки, выполняемые до первого успешного декодирования
+    PreprocessingCascade& getPreprocessingCascade();
+    const PreprocessingCascade& getPreprocessingCascade() const;
 
     int getTotalDetections() const;
     int getSuccessfulDetections() const;
@@ -30,15 +81,30 @@ public:
 
 private:
     cv::QRCodeDetector qr_detector_;
+    PreprocessingCascade cascade_ = PreprocessingCascade::createDefault();
+    QualityGate quality_gate_;
+    bool quality_gate_enabled_ = false;
+    DebugCapture* debug_capture_ = nullptr;
     bool preprocessing_enabled_ = true;
     bool multiple_qr_enabled_ = false;
+    bool retain_processed_image_ = true;
+    bool grayscale_processing_ = false;
+    bool pyramid_localization_enabled_ = false;
+    int localization_max_side_ = 1024;
 
     int total_detections_ = 0;
     int successful_detections_ = 0;
+    double confidence_ms_ = 0.0;    // накапливается за один вызов detectFromImage
 
     DetectionResult processDetection(const cv::Mat& image);
+    DetectionResult processFullFrameDetection(const cv::Mat& image);
+    DetectionResult processLocalizedDetection(const cv::Mat& image);
+    DetectionResult processSingleDetection(const cv::Mat& image);
+    DetectionResult processMultiDetection(const cv::Mat& image);
+    std::vector<cv::Rect> localizeCandidates(const cv::Mat& image);
     bool validateQRData(const std::string& data);
-    double calculateConfidence(const std::vector<cv::Point>& bbox, const cv::Mat& image);
+    double calculateConfidence(const std::vector<cv::Point>& bbox, const cv::Mat& image,
+                               const cv::Mat& straight_qrcode);
 };
 
 #endif // QR_READER_QR_DETECTOR_H
@@ -0,0 +1,134 @@
+#include "qr_tracker.h"
+#include "../utils/logger.h"
+#include <algorithm>
+
+QRTracker::QRTracker(QRDetector& detector) : QRTracker(detector, Config()) {
+}
+
+QRTracker::QRTracker(QRDetector& detector, const Config& config)
+    : detector_(detector), config_(config) {
+}
+
+QRDetector::DetectionResult QRTracker::track(const cv::Mat& frame) {
+    stats_.frames++;
+
+    if (frame.empty()) {
+        return {false, "", {}, 0.0, cv::Mat(), "Empty input frame"};
+    }
+
+    if (!tracking_) {
+        return fullSearch(frame);
+    }
+
+    // Область кода на прежнем месте и не изменилась — декодировать заново незачем
+    cv::Mat patch = samplePatch(frame, last_result_.bounding_box);
+    if (!patch.empty() && !last_patch_.empty() &&
+        cv::norm(patch, last_patch_, cv::NORM_L1) / patch.total() < config_.change_threshold) {
+        stats_.reused_results++;
+        consecutive_misses_ = 0;
+        QRDetector::DetectionResult reused = last_result_;
+        reused.detected_at = std::chrono::system_clock::now();
+        return reused;
+    }
+
+    QRDetector::DetectionResult result = windowSearch(frame);
+    if (result.success) {
+        consecutive_misses_ = 0;
+        startTracking(frame, result);
+        return result;
+    }
+
+    stats_.misses++;
+    consecutive_misses_++;
+    if (consecutive_misses_ < config_.max_misses) {
+        result.error_message = "Tracked QR code not found in search window";
+        return result;
+    }
+
+    QR_LOG_DEBUG("Tracking lost after " + std::to_string(consecutive_misses_) + " misses");
+    reset();
+    return fullSearch(frame);
+}
+
+void QRTracker::reset() {
+    tracking_ = false;
+    consecutive_misses_ = 0;
+    last_result_ = QRDetector::DetectionResult();
+    last_patch_.release();
+}
+
+bool QRTracker::isTracking() const {
+    return tracking_;
+}
+
+const QRTracker::TrackerStats& QRTracker::getStats() const {
+    return stats_;
+}
+
+QRDetector::DetectionResult QRTracker::fullSearch(const cv::Mat& frame) {
+    stats_.full_searches++;
+    QRDetector::DetectionResult result = detector_.detectFromImage(frame);
+    if (result.success && result.bounding_box.size() == 4) {
+        startTracking(frame, result);
+    }
+    return result;
+}
+
+QRDetector::DetectionResult QRTracker::windowSearch(const cv::Mat& frame) {
+    stats_.window_searches++;
+
+    cv::Rect box = cv::boundingRect(last_result_.bounding_box);
+    int margin = static_cast<int>(std::max(box.width, box.height) * config_.search_margin);
+    cv::Rect window = cv::Rect(box.x - margin, box.y - margin,
+                               box.width + 2 * margin, box.height + 2 * margin) &
+                      cv::Rect(0, 0, frame.cols, frame.rows);
+
+    if (window.area() == 0) {
+        return {false, "", {}, 0.0, cv::Mat(), "Search window left the frame"};
+    }
+
+    QRDetector::DetectionResult result = detector_.detectFromImage(frame(window));
+    if (!result.success || result.bounding_box.size() != 4) {
+        result.success = false;
+        return result;
+    }
+
+    for (auto& point : result.bounding_box) {
+        point += window.tl();
+    }
+    for (auto& code : result.codes) {
+        for (auto& point : code.bounding_box) {
+            point += window.tl();
+        }
+    }
+    return result;
+}
+
+void QRTracker::startTracking(const cv::Mat& frame, const QRDetector::DetectionResult& result) {
+    tracking_ = true;
+    last_result_ = result;
+    // Кадр в сохранённом результате не нужен и держал бы буфер потока
+    last_result_.processed_image.release();
+    last_patch_ = samplePatch(frame, result.bounding_box);
+}
+
+cv::Mat QRTracker::samplePatch(const cv::Mat& frame, const std::vector<cv::Point>& corners) const {
+    if (corners.size() != 4) return cv::Mat();
+
+    const float side = static_cast<float>(config_.patch_size);
+    cv::Point2f src[4];
+    for (int i = 0; i < 4; ++i) {
+        src[i] = cv::Point2f(static_cast<float>(corners[i].x), static_cast<float>(corners[i].y));
+    }
+    cv::Point2f dst[4] = {
+        cv::Point2f(0, 0), cv::Point2f(side, 0), cv::Point2f(side, side), cv::Point2f(0, side)
+    };
+
+    cv::Mat patch;
+    cv::warpPerspective(frame, patch, cv::getPerspectiveTransform(src, dst),
+                        cv::Size(config_.patch_size, config_.patch_size), cv::INTER_LINEAR);
+    if (patch.channels() > 1) {
+        cv::cvtColor(patch, patch, cv::COLOR_BGR2GRAY);
+    }
+    return patch;
+}
@@ -0,0 +1,56 @@
+#ifndef QR_READER_QR_TRACKER_H
+#define QR_READER_QR_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "qr_detector.h"
+
+// Сопровождение кода между кадрами видеопотока поверх QRDetector.
+// Если область кода не изменилась — результат прошлого кадра переиспользуется
+// без декодирования; если сместилась — поиск идёт только в окне вокруг прежних
+// углов. Полный поиск по кадру — только после max_misses промахов подряд.
+class QRTracker {
+public:
+    struct Config {
+        double search_margin = 0.75;    // расширение окна поиска в долях размера кода
+        int max_misses = 3;             // промахов в окне до возврата к полному поиску
+        int patch_size = 32;            // сторона выпрямленного патча для сравнения кадров
+        double change_threshold = 8.0;  // средняя абсолютная разница патчей, выше — «изменилось»
+    };
+
+    struct TrackerStats {
+        int64_t frames = 0;
+        int64_t full_searches = 0;
+        int64_t window_searches = 0;
+        int64_t reused_results = 0;
+        int64_t misses = 0;
+    };
+
+    explicit QRTracker(QRDetector& detector);
+    QRTracker(QRDetector& detector, const Config& config);
+
+    QRDetector::DetectionResult track(const cv::Mat& frame);
+
+    void reset();
+    bool isTracking() const;
+    const TrackerStats& getStats() const;
+
+private:
+    QRDetector& detector_;
+    Config config_;
+    TrackerStats stats_;
+
+    bool tracking_ = false;
+    int consecutive_misses_ = 0;
+    QRDetector::DetectionResult last_result_;
+    cv::Mat last_patch_;
+
+    QRDetector::DetectionResult fullSearch(const cv::Mat& frame);
+    QRDetector::DetectionResult windowSearch(const cv::Mat& frame);
+    void startTracking(const cv::Mat& frame, const QRDetector::DetectionResult& result);
+    cv::Mat samplePatch(const cv::Mat& frame, const std::vector<cv::Point>& corners) const;
+};
+
+#endif // QR_READER_QR_TRACKER_H
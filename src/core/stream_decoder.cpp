@@ -0,0 +1,176 @@
+#include "stream_decoder.h"
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+#include "../processors/image_processor.h"
+#include <algorithm>
+
+double StreamDecoder::StreamStats::getCaptureFps() const {
+    if (elapsed_seconds <= 0.0) return 0.0;
+    return frames_captured / elapsed_seconds;
+}
+
+double StreamDecoder::StreamStats::getDecodeFps() const {
+    if (elapsed_seconds <= 0.0) return 0.0;
+    return frames_decoded / elapsed_seconds;
+}
+
+StreamDecoder::StreamDecoder() : StreamDecoder(Config()) {
+}
+
+StreamDecoder::StreamDecoder(const Config& config)
+    : config_(config), debug_capture_(config.debug_capture), source_(config.source) {
+    detector_.setPreprocessingEnabled(config_.preprocessing_enabled);
+    detector_.setMultipleQRDetection(config_.multiple_qr_enabled);
+    detector_.setPyramidLocalization(config_.pyramid_localization);
+    if (!config_.cascade_stages.empty()) {
+        detector_.getPreprocessingCascade().setOrder(config_.cascade_stages);
+    }
+    detector_.setRetainProcessedImage(false);
+    detector_.setGrayscaleProcessing(config_.grayscale);
+    detector_.getQualityGate() = QualityGate(config_.quality_gate);
+    detector_.setQualityGateEnabled(config_.quality_gate_enabled);
+    if (debug_capture_.isEnabled()) {
+        detector_.setDebugCapture(&debug_capture_);
+    }
+}
+
+StreamDecoder::~StreamDecoder() {
+    stop();
+}
+
+StreamDecoder::StreamStats StreamDecoder::run(const ResultCallback& on_result) {
+    ScopedTimer timer("StreamDecoder::run");
+
+    stats_ = StreamStats();
+    slot_full_ = false;
+    capture_finished_ = false;
+    stop_requested_ = false;
+
+    if (!source_.open()) {
+        return stats_;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread capture_thread(&StreamDecoder::captureLoop, this);
+    decodeLoop(on_result);
+    capture_thread.join();
+
+    stats_.elapsed_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    // Видеофайл дочитан до конца — следующий run() начнёт его сначала; камера остаётся открытой
+    if (!FrameSource::isCameraIndex(config_.source)) {
+        source_.release();
+    }
+
+    if (debug_capture_.isEnabled()) {
+        debug_capture_.flush();
+        stats_.capture = debug_capture_.getStats();
+    }
+
+    return stats_;
+}
+
+void StreamDecoder::stop() {
+    stop_requested_ = true;
+    slot_ready_.notify_all();
+}
+
+QRDetector& StreamDecoder::getDetector() {
+    return detector_;
+}
+
+void StreamDecoder::captureLoop() {
+    auto start = std::chrono::steady_clock::now();
+    auto frame_interval = std::chrono::duration<double>(config_.pace_fps > 0.0 ? 1.0 / config_.pace_fps : 0.0);
+    int64_t next_id = 0;
+
+    while (!stop_requested_) {
+        if (config_.max_frames > 0 && next_id >= config_.max_frames) break;
+        if (config_.max_seconds > 0.0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > config_.max_seconds) {
+            break;
+        }
+
+        Frame frame;
+        if (!source_.read(frame.image)) {
+            QR_LOG_INFO("Stream source exhausted after " + std::to_string(next_id) + " frames");
+            break;
+        }
+        if (config_.grayscale && frame.image.channels() != 1) {
+            // Перевод идёт параллельно с детекцией прошлого кадра, а в слот попадает втрое меньший буфер
+            frame.image = ImageProcessor::convertToGrayscale(frame.image);
+        }
+        frame.id = next_id++;
+        frame.captured_at = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(slot_mutex_);
+            stats_.frames_captured++;
+            if (slot_full_) {
+                // Детектор ещё занят прошлым кадром — он уже устарел, заменяем
+                stats_.frames_dropped++;
+            }
+            slot_ = std::move(frame);
+            slot_full_ = true;
+        }
+        slot_ready_.notify_one();
+
+        if (config_.pace_fps > 0.0) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                frame_interval * static_cast<double>(next_id)));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex_);
+        capture_finished_ = true;
+    }
+    slot_ready_.notify_all();
+}
+
+void StreamDecoder::decodeLoop(const ResultCallback& on_result) {
+    double total_latency_ms = 0.0;
+    QRTracker tracker(detector_, config_.tracker);
+
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(slot_mutex_);
+            slot_ready_.wait(lock, [this] { return slot_full_ || capture_finished_ || stop_requested_; });
+            if (!slot_full_) break;
+            frame = std::move(slot_);
+            slot_full_ = false;
+        }
+
+        FrameResult result;
+        result.frame_id = frame.id;
+        if (config_.tracking_enabled) {
+            result.detection = tracker.track(frame.image);
+        } else {
+            // Имя кадра нужно только для отладочных снимков — без них не собираем строку
+            std::string source = debug_capture_.isEnabled() ? config_.source + "#" + std::to_string(frame.id)
+                                                            : std::string();
+            result.detection = detector_.detectFromImage(frame.image, source);
+        }
+        result.latency_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - frame.captured_at).count();
+
+        {
+            std::lock_guard<std::mutex> lock(slot_mutex_);
+            stats_.frames_decoded++;
+            if (result.detection.success) {
+                stats_.successful_decodes++;
+            }
+            total_latency_ms += result.latency_ms;
+            stats_.avg_latency_ms = total_latency_ms / stats_.frames_decoded;
+            stats_.max_latency_ms = std::max(stats_.max_latency_ms, result.latency_ms);
+            stats_.tracker = tracker.getStats();
+            stats_.gate = detector_.getQualityGate().getStats();
+        }
+
+        if (on_result) {
+            on_result(result);
+        }
+    }
+}
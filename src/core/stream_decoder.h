@@ -0,0 +1,99 @@
+#ifndef QR_READER_STREAM_DECODER_H
+#define QR_READER_STREAM_DECODER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "qr_detector.h"
+#include "qr_tracker.h"
+#include "../io/frame_source.h"
+
+// Непрерывное декодирование видеопотока: захват и детекция идут в разных потоках,
+// между ними — слот на один кадр. Если детектор не успевает, устаревший кадр
+// заменяется свежим и учитывается как пропущенный.
+class StreamDecoder {
+public:
+    struct Config {
+        std::string source = "0";       // индекс камеры, видеофайл или шаблон "frames/%04d.png"
+        int max_frames = 0;             // 0 = без ограничения
+        double max_seconds = 0.0;       // 0 = без ограничения
+        double pace_fps = 0.0;          // темп подачи кадров из файла, 0 = как можно быстрее
+        bool preprocessing_enabled = false;
+        bool multiple_qr_enabled = false;
+        bool pyramid_localization = false;
+        std::vector<std::string> cascade_stages;    // порядок стадий предобработки, пусто = по умолчанию
+        bool grayscale = false;         // переводить кадр в один канал в потоке захвата, до детектора
+        bool tracking_enabled = false;  // сопровождать код между кадрами вместо полного поиска
+        QRTracker::Config tracker;
+        bool quality_gate_enabled = false;  // не декодировать пустые, размытые и пересвеченные кадры
+        QualityGate::Config quality_gate;
+        DebugCapture::Config debug_capture; // снимки кадров без кода, выключено по умолчанию
+    };
+
+    struct FrameResult {
+        int64_t frame_id = 0;
+        double latency_ms = 0.0;        // от получения кадра до готового результата
+        QRDetector::DetectionResult detection;
+    };
+
+    struct StreamStats {
+        int64_t frames_captured = 0;
+        int64_t frames_decoded = 0;
+        int64_t frames_dropped = 0;
+        int64_t successful_decodes = 0;
+        double avg_latency_ms = 0.0;
+        double max_latency_ms = 0.0;
+        double elapsed_seconds = 0.0;
+        QRTracker::TrackerStats tracker;
+        QualityGate::GateStats gate;
+        DebugCapture::CaptureStats capture;
+
+        double getCaptureFps() const;
+        double getDecodeFps() const;
+    };
+
+    using ResultCallback = std::function<void(const FrameResult&)>;
+
+    StreamDecoder();
+    explicit StreamDecoder(const Config& config);
+    ~StreamDecoder();
+
+    // Блокирует до конца потока, достижения лимитов или вызова stop()
+    StreamStats run(const ResultCallback& on_result = ResultCallback());
+    void stop();
+
+    QRDetector& getDetector();
+
+private:
+    struct Frame {
+        cv::Mat image;
+        int64_t id = 0;
+        std::chrono::steady_clock::time_point captured_at;
+    };
+
+    Config config_;
+    DebugCapture debug_capture_;
+    QRDetector detector_;
+    // Камера живёт вместе с декодером: повторный run() не открывает устройство заново
+    FrameSource source_;
+
+    std::mutex slot_mutex_;
+    std::condition_variable slot_ready_;
+    Frame slot_;
+    bool slot_full_ = false;
+    bool capture_finished_ = false;
+    std::atomic<bool> stop_requested_{false};
+
+    StreamStats stats_;
+
+    void captureLoop();
+    void decodeLoop(const ResultCallback& on_result);
+};
+
+#endif // QR_READER_STREAM_DECODER_H
@@ -0,0 +1,165 @@
+#include "debug_capture.h"
+#include "../utils/logger.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+namespace {
+
+const size_t MAX_STEM_LENGTH = 48;
+
+} // namespace
+
+DebugCapture::DebugCapture() : DebugCapture(Config()) {
+}
+
+DebugCapture::DebugCapture(const Config& config) : config_(config), queue_(config.queue_capacity) {
+    if (!config_.enabled) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(config_.directory, ec);
+    if (ec) {
+        QR_LOG_ERROR("Cannot create debug capture directory " + config_.directory + ": " + ec.message());
+        config_.enabled = false;
+        return;
+    }
+
+    worker_ = std::thread(&DebugCapture::encodeLoop, this);
+    QR_LOG_INFO("Debug capture enabled: " + config_.directory + " (sample rate " +
+                std::to_string(config_.sample_rate) + ", budget " +
+                std::to_string(config_.max_total_bytes >> 20) + " MB)");
+}
+
+DebugCapture::~DebugCapture() {
+    // Оставшиеся в очереди кадры дописываются до выхода
+    queue_.close();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void DebugCapture::capture(const cv::Mat& image, const std::string& source, const std::string& tag) {
+    if (!config_.enabled || image.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (!shouldSample(stats_.offered++)) {
+        return;
+    }
+    stats_.sampled++;
+
+    // Бюджет уже исчерпан — не тратим на кадр ни очередь, ни кодирование
+    if (bytes_on_disk_.load(std::memory_order_relaxed) >= static_cast<int64_t>(config_.max_total_bytes)) {
+        stats_.dropped_budget++;
+        return;
+    }
+
+    Job job{image, makeFileName(source, tag, stats_.sampled)};
+    if (!queue_.tryPush(std::move(job))) {
+        stats_.dropped_queue++;
+        return;
+    }
+    pending_++;
+}
+
+void DebugCapture::flush() {
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    idle_.wait(lock, [this] { return pending_ == 0; });
+}
+
+bool DebugCapture::isEnabled() const {
+    return config_.enabled;
+}
+
+DebugCapture::CaptureStats DebugCapture::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+bool DebugCapture::shouldSample(int64_t ordinal) const {
+    if (config_.sample_rate >= 1.0) return true;
+    if (config_.sample_rate <= 0.0) return false;
+
+    // Равномерный детерминированный отбор: кадр берётся, когда накопленная доля
+    // переходит через целое число; первый неудачный кадр сохраняется всегда
+    if (ordinal == 0) return true;
+    return std::floor(ordinal * config_.sample_rate) > std::floor((ordinal - 1) * config_.sample_rate);
+}
+
+std::string DebugCapture::makeFileName(const std::string& source, const std::string& tag,
+                                       int64_t sequence) const {
+    std::string stem = std::filesystem::path(source).stem().string();
+    if (stem.empty()) {
+        stem = "frame";
+    }
+    if (stem.size() > MAX_STEM_LENGTH) {
+        stem.resize(MAX_STEM_LENGTH);
+    }
+    for (char& c : stem) {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                    c == '-' || c == '_';
+        if (!safe) c = '_';
+    }
+
+    // Хэш полного пути различает одноимённые файлы из разных каталогов,
+    // порядковый номер — повторные снимки одного источника
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), "_%08x_%06lld_",
+                  static_cast<unsigned>(std::hash<std::string>()(source) & 0xffffffffu),
+                  static_cast<long long>(sequence));
+
+    return (std::filesystem::path(config_.directory) / (stem + suffix + tag + config_.extension)).string();
+}
+
+void DebugCapture::encodeLoop() {
+    Job job;
+    while (queue_.pop(job)) {
+        std::vector<uchar> encoded;
+        bool encoded_ok = false;
+        try {
+            encoded_ok = cv::imencode(config_.extension, job.image, encoded);
+        } catch (const cv::Exception& e) {
+            QR_LOG_WARNING("Debug capture encode failed: " + std::string(e.what()));
+        }
+        // Пиксели больше не нужны — отпускаем буфер вызывающего сразу после кодирования
+        job.image.release();
+
+        bool over_budget = false;
+        bool written = false;
+        if (encoded_ok) {
+            int64_t size = static_cast<int64_t>(encoded.size());
+            if (bytes_on_disk_.load(std::memory_order_relaxed) + size >
+                static_cast<int64_t>(config_.max_total_bytes)) {
+                over_budget = true;
+            } else {
+                std::ofstream file(job.file_name, std::ios::binary);
+                file.write(reinterpret_cast<const char*>(encoded.data()), size);
+                written = static_cast<bool>(file);
+                if (written) {
+                    bytes_on_disk_ += size;
+                } else {
+                    QR_LOG_WARNING("Cannot write debug capture " + job.file_name);
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            if (written) {
+                stats_.written++;
+                stats_.bytes_written = bytes_on_disk_.load(std::memory_order_relaxed);
+            } else if (over_budget) {
+                stats_.dropped_budget++;
+            } else {
+                stats_.failed++;
+            }
+            pending_--;
+        }
+        idle_.notify_all();
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef QR_READER_DEBUG_CAPTURE_H
+#define QR_READER_DEBUG_CAPTURE_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../utils/bounded_queue.h"
+
+// Сохранение кадров, на которых детекция не удалась, для последующего разбора.
+// Выключено по умолчанию. Кадры отбираются с заданной долей, кодируются и пишутся
+// в фоновом потоке; общий объём на диске ограничен бюджетом. Имена файлов
+// уникальны и содержат источник кадра, поэтому параллельные потоки не затирают
+// снимки друг друга.
+class DebugCapture {
+public:
+    struct Config {
+        bool enabled = false;
+        std::string directory = "debug";
+        double sample_rate = 1.0;               // доля неудачных кадров, которые сохраняются
+        size_t max_total_bytes = 256u << 20;    // бюджет на диске; исчерпан — снимки отбрасываются
+        size_t queue_capacity = 16;             // кадров в ожидании кодирования
+        std::string extension = ".png";         // формат задаётся расширением imencode
+    };
+
+    struct CaptureStats {
+        int64_t offered = 0;        // неудачных кадров передано в capture()
+        int64_t sampled = 0;        // прошли выборку
+        int64_t written = 0;
+        int64_t bytes_written = 0;
+        int64_t dropped_queue = 0;  // очередь кодирования была полна
+        int64_t dropped_budget = 0; // бюджет на диске исчерпан
+        int64_t failed = 0;         // ошибка кодирования или записи
+    };
+
+    DebugCapture();
+    explicit DebugCapture(const Config& config);
+    ~DebugCapture();
+
+    DebugCapture(const DebugCapture&) = delete;
+    DebugCapture& operator=(const DebugCapture&) = delete;
+
+    // Не блокирует: кадр ставится в очередь без копирования пикселей
+    // (заголовок удерживает буфер вызывающего до окончания записи),
+    // при полной очереди снимок отбрасывается. tag различает виды снимков.
+    void capture(const cv::Mat& image, const std::string& source, const std::string& tag = "original");
+
+    // Ждёт, пока фоновый поток запишет всё поставленное в очередь
+    void flush();
+
+    bool isEnabled() const;
+    CaptureStats getStats() const;
+
+private:
+    struct Job {
+        cv::Mat image;
+        std::string file_name;
+    };
+
+    Config config_;
+    BoundedQueue<Job> queue_;
+    std::thread worker_;
+
+    std::atomic<int64_t> bytes_on_disk_{0};
+
+    mutable std::mutex stats_mutex_;   // защищает stats_ и pending_
+    std::condition_variable idle_;
+    int64_t pending_ = 0;
+    CaptureStats stats_;
+
+    bool shouldSample(int64_t ordinal) const;
+    std::string makeFileName(const std::string& source, const std::string& tag, int64_t sequence) const;
+    void encodeLoop();
+};
+
+#endif // QR_READER_DEBUG_CAPTURE_H
@@ -0,0 +1,59 @@
+#include "frame_source.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <cctype>
+
+FrameSource::FrameSource(const std::string& source) : source_(source) {
+}
+
+FrameSource::~FrameSource() {
+    release();
+}
+
+bool FrameSource::open() {
+    if (capture_.isOpened()) {
+        return true;
+    }
+
+    if (isCameraIndex(source_)) {
+        QR_LOG_INFO("Opening camera device: " + source_);
+        capture_.open(std::stoi(source_));
+        // Держим в буфере драйвера минимум кадров, чтобы не копить задержку
+        capture_.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    } else {
+        capture_.open(source_);
+    }
+
+    if (!capture_.isOpened()) {
+        QR_LOG_ERROR("Failed to open frame source: " + source_);
+        return false;
+    }
+    return true;
+}
+
+bool FrameSource::read(cv::Mat& frame) {
+    if (!open()) {
+        return false;
+    }
+    return capture_.read(frame) && !frame.empty();
+}
+
+void FrameSource::release() {
+    if (capture_.isOpened()) {
+        capture_.release();
+    }
+}
+
+bool FrameSource::isOpened() const {
+    return capture_.isOpened();
+}
+
+const std::string& FrameSource::getSource() const {
+    return source_;
+}
+
+bool FrameSource::isCameraIndex(const std::string& source) {
+    // Длинные строки цифр — не индекс камеры, а имя файла; заодно std::stoi не переполнится
+    return !source.empty() && source.size() <= 4 &&
+        std::all_of(source.begin(), source.end(), [](unsigned char c) { return std::isdigit(c); });
+}
@@ -0,0 +1,35 @@
+#ifndef QR_READER_FRAME_SOURCE_H
+#define QR_READER_FRAME_SOURCE_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Источник кадров: камера, видеофайл или шаблон последовательности изображений.
+// Устройство открывается при первом чтении и остаётся открытым до release() или
+// разрушения объекта — повторные кадры не платят за открытие камеры.
+class FrameSource {
+public:
+    // source — индекс камеры ("0"), путь к видеофайлу или шаблон "frames/%04d.png"
+    explicit FrameSource(const std::string& source = "0");
+    ~FrameSource();
+
+    FrameSource(const FrameSource&) = delete;
+    FrameSource& operator=(const FrameSource&) = delete;
+
+    // Повторный вызов на открытом источнике ничего не делает
+    bool open();
+    // Открывает источник при необходимости; false — ошибка открытия или кадры кончились
+    bool read(cv::Mat& frame);
+    void release();
+
+    bool isOpened() const;
+    const std::string& getSource() const;
+
+    static bool isCameraIndex(const std::string& source);
+
+private:
+    std::string source_;
+    cv::VideoCapture capture_;
+};
+
+#endif // QR_READER_FRAME_SOURCE_H
@@ -0,0 +1,90 @@
+#include "image_buffer_pool.h"
+#include <algorithm>
+#include <climits>
+
+ImageBufferPool::ImageBufferPool(size_t max_pooled_bytes) : max_pooled_bytes_(max_pooled_bytes) {
+}
+
+cv::Mat ImageBufferPool::acquire(cv::Size size, int type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.acquisitions++;
+
+    if (CV_MAT_DEPTH(type) != CV_8U || size.width <= 0 || size.height <= 0) {
+        stats_.allocations++;
+        return cv::Mat(size, type);
+    }
+
+    size_t bytes = static_cast<size_t>(size.width) * static_cast<size_t>(size.height) * CV_MAT_CN(type);
+    size_t capacity = resolutionClass(bytes);
+
+    // Хранилище — одна строка Mat, её длина ограничена int; такой кадр в пул всё равно не влезет
+    if (capacity > static_cast<size_t>(INT_MAX) || capacity > max_pooled_bytes_) {
+        stats_.allocations++;
+        return cv::Mat(size, type);
+    }
+
+    auto& bucket = buckets_[capacity];
+    for (const auto& storage : bucket) {
+        if (isFree(storage)) {
+            stats_.reuses++;
+            return viewOf(storage, size, type);
+        }
+    }
+
+    stats_.allocations++;
+    cv::Mat storage(1, static_cast<int>(capacity), CV_8UC1);
+    if (stats_.pooled_bytes + capacity <= max_pooled_bytes_) {
+        bucket.push_back(storage);
+        stats_.pooled_bytes += capacity;
+    }
+    return viewOf(storage, size, type);
+}
+
+void ImageBufferPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& bucket : buckets_) {
+        auto& buffers = bucket.second;
+        for (size_t i = 0; i < buffers.size();) {
+            if (isFree(buffers[i])) {
+                stats_.pooled_bytes -= bucket.first;
+                buffers.erase(buffers.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+    }
+}
+
+ImageBufferPool::PoolStats ImageBufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t ImageBufferPool::resolutionClass(size_t bytes) {
+    // Четыре класса на каждую степень двойки: потеря памяти не больше 25%,
+    // а кадры близких разрешений делят одни и те же буферы
+    size_t power = 1;
+    while (power * 2 <= bytes) {
+        power *= 2;
+    }
+    if (power == bytes) return bytes;
+
+    size_t step = std::max<size_t>(power / 4, 1);
+    return ((bytes + step - 1) / step) * step;
+}
+
+bool ImageBufferPool::isFree(const cv::Mat& storage) {
+    // Единственная ссылка — у самого пула. Копии кадра в других потоках меняют счётчик через
+    // CV_XADD, поэтому и читаем его атомарно: простое чтение — гонка данных, и буфер мог бы уйти
+    // новому владельцу раньше, чем прежний закончил с ним работать
+    return storage.u != nullptr && CV_XADD(&storage.u->refcount, 0) == 1;
+}
+
+cv::Mat ImageBufferPool::viewOf(const cv::Mat& storage, cv::Size size, int type) {
+    // Однострочная подматрица непрерывна, её можно переложить в кадр нужной формы,
+    // сохранив общий с хранилищем счётчик ссылок
+    // acquire() гарантирует, что размер кадра умещается в int
+    int bytes = static_cast<int>(static_cast<size_t>(size.width) * static_cast<size_t>(size.height) *
+                                 CV_MAT_CN(type));
+    return storage.colRange(0, bytes).reshape(CV_MAT_CN(type), size.height);
+}
@@ -0,0 +1,45 @@
+#ifndef QR_READER_IMAGE_BUFFER_POOL_H
+#define QR_READER_IMAGE_BUFFER_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Пул буферов для декодированных кадров, сгруппированных по классам разрешения.
+// acquire() возвращает Mat точного размера поверх буфера своего класса и делит
+// с ним счётчик ссылок: буфер снова свободен, как только отпущены все внешние
+// копии, поэтому явный release() не нужен.
+class ImageBufferPool {
+public:
+    struct PoolStats {
+        int64_t acquisitions = 0;
+        int64_t reuses = 0;
+        int64_t allocations = 0;
+        size_t pooled_bytes = 0;
+    };
+
+    explicit ImageBufferPool(size_t max_pooled_bytes = size_t(512) << 20);
+
+    // Только 8-битные типы; для прочих возвращается обычный Mat
+    cv::Mat acquire(cv::Size size, int type);
+
+    // Освобождает все буферы, которые сейчас никем не используются
+    void trim();
+
+    PoolStats getStats() const;
+
+private:
+    size_t max_pooled_bytes_;
+    mutable std::mutex mutex_;
+    // класс разрешения (ёмкость в байтах) -> буферы вида 1 x capacity CV_8UC1
+    std::map<size_t, std::vector<cv::Mat>> buckets_;
+    PoolStats stats_;
+
+    static size_t resolutionClass(size_t bytes);
+    static bool isFree(const cv::Mat& storage);
+    static cv::Mat viewOf(const cv::Mat& storage, cv::Size size, int type);
+};
+
+#endif // QR_READER_IMAGE_BUFFER_POOL_H
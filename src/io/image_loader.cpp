@@ -1,61 +1,209 @@
 #include "image_loader.h"
 #include "../utils/logger.h"
-#include <filesystem>
+#include "../utils/profiler.h"
+#include <algorithm>
+#include <climits>
+#include <fstream>
 
 const std::vector<std::string> SUPPORTED_FORMATS = {
     ".jpg", ".jpeg", ".png", ".bmp", ".tiff", ".tif", ".webp"
 };
 
+std::atomic<int64_t> ImageLoader::files_opened_{0};
+std::atomic<int64_t> ImageLoader::bytes_read_{0};
+std::atomic<int64_t> ImageLoader::images_decoded_{0};
+std::atomic<int64_t> ImageLoader::pooled_decodes_{0};
+std::atomic<int64_t> ImageLoader::decode_allocations_{0};
+std::atomic<int64_t> ImageLoader::reduced_decodes_{0};
+
+const uchar* ImageLoader::FileData::data() const {
+    return mapping ? mapping->data() : nullptr;
+}
+
+size_t ImageLoader::FileData::size() const {
+    return mapping ? mapping->size() : 0;
+}
+
 ImageLoader::LoadResult ImageLoader::loadFromFile(const std::string& file_path) {
-    Logger::startOperation("Loading image from file: " + file_path);
+    return loadFromFile(file_path, DecodeOptions());
+}
 
-    if (!std::filesystem::exists(file_path)) {
-        Logger::error("File does not exist: " + file_path);
-        return createErrorResult("File does not exist: " + file_path, file_path);
+ImageLoader::LoadResult ImageLoader::loadFromFile(const std::string& file_path, const DecodeOptions& options) {
+    ScopedTimer timer("ImageLoader::loadFromFile");
+
+    FileData file = readFile(file_path);
+    if (!file.success) {
+        return createErrorResult(file.error_msg, file_path);
     }
 
+    LoadResult result = loadFromMemory(file.data(), file.size(), file_path, options);
+    if (!result.success) {
+        return result;
+    }
+
+    QR_LOG_INFO("Image loaded successfully: " + getImageInfo(result.image));
+
+    return result;
+}
+
+ImageLoader::FileData ImageLoader::readFile(const std::string& file_path) {
     std::string extension = getFileExtension(file_path);
     if (!isSupportedFormat(extension)) {
-        Logger::error("Unsupported image format: " + extension);
-        return createErrorResult("Unsupported image format: " + extension, file_path);
+        QR_LOG_ERROR("Unsupported image format: " + extension);
+        return {false, nullptr, "Unsupported image format: " + extension, file_path};
     }
 
-    cv::Mat image = cv::imread(file_path, cv::IMREAD_COLOR);
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->open(file_path)) {
+        if (mapping->notFound()) {
+            QR_LOG_ERROR("File does not exist: " + file_path);
+            return {false, nullptr, "File does not exist: " + file_path, file_path};
+        }
+        QR_LOG_ERROR("Failed to open file: " + file_path + " (" + mapping->getError() + ")");
+        return {false, nullptr, "Failed to open file: " + file_path, file_path};
+    }
 
-    if (image.empty()) {
-        Logger::error("Failed to load image (may be corrupted): " + file_path);
-        return createErrorResult("Failed to load image (file may be corrupted)", file_path);
+    files_opened_++;
+    bytes_read_ += static_cast<int64_t>(mapping->size());
+    return {true, std::move(mapping), "", file_path};
+}
+
+bool ImageLoader::readFileCopy(const std::string& file_path, std::vector<uchar>& buffer, std::string& error_msg) {
+    std::string extension = getFileExtension(file_path);
+    if (!isSupportedFormat(extension)) {
+        error_msg = "Unsupported image format: " + extension;
+        return false;
+    }
+
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file) {
+        error_msg = "Failed to open file: " + file_path;
+        return false;
+    }
+
+    // Размер может меняться прямо во время чтения — читаем до EOF, а не по stat
+    buffer.clear();
+    const size_t CHUNK = 256 * 1024;
+    while (file) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + CHUNK);
+        file.read(reinterpret_cast<char*>(buffer.data() + offset), static_cast<std::streamsize>(CHUNK));
+        buffer.resize(offset + static_cast<size_t>(file.gcount()));
+    }
+    if (file.bad()) {
+        error_msg = "Failed to read file: " + file_path;
+        return false;
     }
 
-    Logger::info("Image loaded successfully: " + getImageInfo(image));
-    Logger::endOperation("Loading image from file");
+    files_opened_++;
+    bytes_read_ += static_cast<int64_t>(buffer.size());
+    return true;
+}
 
-    return {true, image, "", file_path};
+ImageLoader::LoadResult ImageLoader::loadFromBuffer(const std::vector<uchar>& buffer, const std::string& source) {
+    return loadFromMemory(buffer.data(), buffer.size(), source);
 }
 
-ImageLoader::LoadResult ImageLoader::loadFromWebcam(int camera_index) {
-    Logger::startOperation("Loading image from webcam (device " + std::to_string(camera_index) + ")");
+ImageLoader::LoadResult ImageLoader::loadFromMemory(const uchar* data, size_t size, const std::string& source) {
+    return loadFromMemory(data, size, source, DecodeOptions());
+}
+
+ImageLoader::LoadResult ImageLoader::loadFromMemory(const uchar* data, size_t size, const std::string& source,
+                                                    const DecodeOptions& options) {
+    ScopedTimer timer("ImageLoader::loadFromMemory");
+
+    if (data == nullptr || size == 0) {
+        QR_LOG_ERROR("Cannot decode empty buffer: " + source);
+        return createErrorResult("Empty image buffer", source);
+    }
+    if (size > static_cast<size_t>(INT_MAX)) {
+        QR_LOG_ERROR("Encoded image is too large: " + source);
+        return createErrorResult("Encoded image is too large", source);
+    }
+
+    const int flags = getDecodeFlags(options);
+    const int reduction = flags == cv::IMREAD_COLOR || flags == cv::IMREAD_GRAYSCALE ? 1 : options.reduction;
 
-    cv::VideoCapture cap(camera_index);
+    // Заголовок Mat поверх входных байтов — без копирования
+    cv::Mat encoded(1, static_cast<int>(size), CV_8UC1, const_cast<uchar*>(data));
 
-    if (!cap.isOpened()) {
-        Logger::error("Failed to open webcam device: " + std::to_string(camera_index));
-        return createErrorResult("Failed to open webcam device: " + std::to_string(camera_index));
+    // Если размер известен по заголовку файла, декодируем прямо в буфер из пула.
+    // JPEG уменьшается внутри декодера (размер округляется вверх), остальные
+    // форматы OpenCV декодирует целиком и затем уменьшает — там пул не поможет.
+    cv::Mat image;
+    cv::Size header_size;
+    bool is_jpeg = false;
+    bool header_known = peekImageSize(data, size, header_size, is_jpeg);
+    if (header_known &&
+        static_cast<int64_t>(header_size.width) * header_size.height > options.max_pixels) {
+        // Заголовок может заявлять любые размеры — не верим ему на слово
+        QR_LOG_ERROR("Image dimensions exceed limit (" + std::to_string(header_size.width) + "x" +
+                     std::to_string(header_size.height) + "): " + source);
+        return createErrorResult("Image dimensions exceed limit", source);
     }
+    const uchar* pooled_data = nullptr;
 
-    cv::Mat frame;
-    cap >> frame;
-    cap.release();
+    try {
+        if (header_known && (reduction == 1 || is_jpeg)) {
+            cv::Size target((header_size.width + reduction - 1) / reduction,
+                            (header_size.height + reduction - 1) / reduction);
+            image = getBufferPool().acquire(target, options.grayscale ? CV_8UC1 : CV_8UC3);
+            pooled_data = image.data;
+        }
+        cv::imdecode(encoded, flags, &image);
+    }
+    catch (const cv::Exception& e) {
+        QR_LOG_ERROR("OpenCV exception while decoding " + source + ": " + std::string(e.what()));
+        image.release();
+    }
+    catch (const std::bad_alloc&) {
+        QR_LOG_ERROR("Out of memory while decoding " + source);
+        image.release();
+    }
 
-    if (frame.empty()) {
-        Logger::error("Failed to capture frame from webcam");
-        return createErrorResult("Failed to capture frame from webcam");
+    if (image.empty()) {
+        QR_LOG_ERROR("Failed to decode image (may be corrupted): " + source);
+        return createErrorResult("Failed to decode image (file may be corrupted)", source);
     }
 
-    Logger::info("Webcam image captured: " + getImageInfo(frame));
-    Logger::endOperation("Loading image from webcam");
+    images_decoded_++;
+    if (reduction > 1) {
+        reduced_decodes_++;
+    }
+    if (pooled_data != nullptr && image.data == pooled_data) {
+        pooled_decodes_++;
+    } else {
+        // Формат без разбора заголовка или поворот по EXIF изменил геометрию
+        decode_allocations_++;
+    }
+
+    QR_LOG_DEBUG("Image decoded from memory: " + getImageInfo(image));
+    return {true, image, "", source, reduction};
+}
+
+ImageBufferPool& ImageLoader::getBufferPool() {
+    static ImageBufferPool pool;
+    return pool;
+}
+
+ImageLoader::LoaderStats ImageLoader::getStats() {
+    LoaderStats stats;
+    stats.files_opened = files_opened_.load();
+    stats.bytes_read = bytes_read_.load();
+    stats.images_decoded = images_decoded_.load();
+    stats.pooled_decodes = pooled_decodes_.load();
+    stats.decode_allocations = decode_allocations_.load();
+    stats.reduced_decodes = reduced_decodes_.load();
+    return stats;
+}
 
-    return {true, frame, "", "webcam_device_" + std::to_string(camera_index)};
+void ImageLoader::resetStats() {
+    files_opened_ = 0;
+    bytes_read_ = 0;
+    images_decoded_ = 0;
+    pooled_decodes_ = 0;
+    decode_allocations_ = 0;
+    reduced_decodes_ = 0;
 }
 
 bool ImageLoader::isValidImage(const cv::Mat& image) {
@@ -105,6 +253,64 @@ bool ImageLoader::isSupportedFormat(const std::string& extension) {
     return false;
 }
 
+int ImageLoader::getDecodeFlags(const DecodeOptions& options) {
+    switch (options.reduction) {
+        case 2: return options.grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+        case 4: return options.grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+        case 8: return options.grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+        default: return options.grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+    }
+}
+
+bool ImageLoader::peekImageSize(const uchar* data, size_t size, cv::Size& image_size, bool& is_jpeg) {
+    is_jpeg = false;
+
+    auto read_be16 = [data](size_t pos) { return (data[pos] << 8) | data[pos + 1]; };
+    auto read_be32 = [data](size_t pos) {
+        return (static_cast<uint32_t>(data[pos]) << 24) | (static_cast<uint32_t>(data[pos + 1]) << 16) |
+               (static_cast<uint32_t>(data[pos + 2]) << 8) | static_cast<uint32_t>(data[pos + 3]);
+    };
+
+    // PNG: сигнатура, затем первый чанк IHDR с шириной и высотой
+    static const uchar PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    if (size >= 24 && std::equal(PNG_SIGNATURE, PNG_SIGNATURE + 8, data) &&
+        std::equal(data + 12, data + 16, "IHDR")) {
+        image_size = cv::Size(static_cast<int>(read_be32(16)), static_cast<int>(read_be32(20)));
+        return image_size.width > 0 && image_size.height > 0;
+    }
+
+    // JPEG: идём по сегментам до первого SOFn
+    if (size >= 4 && data[0] == 0xFF && data[1] == 0xD8) {
+        is_jpeg = true;
+        size_t pos = 2;
+        while (pos + 4 <= size) {
+            if (data[pos] != 0xFF) return false;
+            uchar marker = data[pos + 1];
+            if (marker == 0xFF) {
+                pos++;
+                continue;
+            }
+            if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+                pos += 2;
+                continue;
+            }
+
+            size_t length = static_cast<size_t>(read_be16(pos + 2));
+            bool is_sof = marker >= 0xC0 && marker <= 0xCF &&
+                          marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+            if (is_sof) {
+                if (pos + 9 > size) return false;
+                image_size = cv::Size(read_be16(pos + 7), read_be16(pos + 5));
+                return image_size.width > 0 && image_size.height > 0;
+            }
+            if (marker == 0xD9 || marker == 0xDA) return false;
+            pos += 2 + length;
+        }
+    }
+
+    return false;
+}
+
 ImageLoader::LoadResult ImageLoader::createErrorResult(const std::string& error_msg, const std::string& file_path) {
     return {false, cv::Mat(), error_msg, file_path};
 }
@@ -2,7 +2,13 @@
 #define QR_READER_IMAGE_LOADER_H
 
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+#include "image_buffer_pool.h"
+#include "mapped_file.h"
 
 class ImageLoader {
 public:
@@ -11,11 +17,52 @@ public:
         cv::Mat image;
         std::string error_msg;
         std::string file_path;
+        int reduction = 1;              // во сколько раз кадр меньше исходного
+    };
+
+    struct DecodeOptions {
+        int reduction = 1;              // 1, 2, 4 или 8: встроенное уменьшение декодера JPEG
+        bool grayscale = false;         // декодировать сразу в один канал
+        // Предел по заголовку файла: больший кадр отклоняется до выделения памяти.
+        // По умолчанию совпадает с CV_IO_MAX_IMAGE_PIXELS самого OpenCV
+        int64_t max_pixels = int64_t(1) << 30;
+    };
+
+    struct FileData {
+        bool success;
+        std::shared_ptr<MappedFile> mapping;
+        std::string error_msg;
+        std::string file_path;
+
+        const uchar* data() const;
+        size_t size() const;
+    };
+
+    struct LoaderStats {
+        int64_t files_opened = 0;
+        int64_t bytes_read = 0;
+        int64_t images_decoded = 0;
+        int64_t pooled_decodes = 0;     // декодировано прямо в буфер из пула
+        int64_t decode_allocations = 0; // декодеру пришлось выделить свой буфер
+        int64_t reduced_decodes = 0;
     };
 
     static LoadResult loadFromFile(const std::string& file_path);
+    static LoadResult loadFromFile(const std::string& file_path, const DecodeOptions& options);
+
+    // Раздельные шаги для конвейера: отображение файла в память и декодирование из памяти
+    static FileData readFile(const std::string& file_path);
+    // Копия файла в собственный буфер обычным чтением, без mmap: для файлов, которые
+    // другой процесс может обрезать во время декодирования (отображение дало бы SIGBUS)
+    static bool readFileCopy(const std::string& file_path, std::vector<uchar>& buffer, std::string& error_msg);
+    static LoadResult loadFromBuffer(const std::vector<uchar>& buffer, const std::string& source = "");
+    static LoadResult loadFromMemory(const uchar* data, size_t size, const std::string& source = "");
+    static LoadResult loadFromMemory(const uchar* data, size_t size, const std::string& source,
+                                     const DecodeOptions& options);
 
-    static LoadResult loadFromWebcam(int camera_index = 0);
+    static ImageBufferPool& getBufferPool();
+    static LoaderStats getStats();
+    static void resetStats();
 
     static bool isValidImage(const cv::Mat& image);
 
@@ -25,6 +72,15 @@ private:
     static std::string getFileExtension(const std::string& file_path);
     static bool isSupportedFormat(const std::string& extension);
     static LoadResult createErrorResult(const std::string& error_msg, const std::string& file_path = "");
+    static bool peekImageSize(const uchar* data, size_t size, cv::Size& image_size, bool& is_jpeg);
+    static int getDecodeFlags(const DecodeOptions& options);
+
+    static std::atomic<int64_t> files_opened_;
+    static std::atomic<int64_t> bytes_read_;
+    static std::atomic<int64_t> images_decoded_;
+    static std::atomic<int64_t> pooled_decodes_;
+    static std::atomic<int64_t> decode_allocations_;
+    static std::atomic<int64_t> reduced_decodes_;
 };
 
 #endif // QR_READER_IMAGE_LOADER_H
@@ -0,0 +1,106 @@
+#include "mapped_file.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& file_path) {
+    close();
+
+#ifdef __unix__
+    // Один open() вместо exists() + imread(): и проверка наличия, и доступ к данным
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        not_found_ = errno == ENOENT;
+        error_ = std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        error_ = std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            error_ = std::strerror(errno);
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        // Декодер читает файл от начала до конца — подсказываем ядру упреждающее чтение
+        ::madvise(address, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const unsigned char*>(address);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        not_found_ = true;
+        error_ = "cannot open file";
+        return false;
+    }
+    fallback_.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!fallback_.empty() && !file.read(reinterpret_cast<char*>(fallback_.data()), fallback_.size())) {
+        error_ = "read failed";
+        fallback_.clear();
+        return false;
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#endif
+
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef __unix__
+    if (mapped_) {
+        ::munmap(const_cast<unsigned char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    open_ = false;
+    not_found_ = false;
+    error_.clear();
+    std::vector<unsigned char>().swap(fallback_);
+}
+
+const unsigned char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+bool MappedFile::isOpen() const {
+    return open_;
+}
+
+bool MappedFile::notFound() const {
+    return not_found_;
+}
+
+const std::string& MappedFile::getError() const {
+    return error_;
+}
@@ -0,0 +1,39 @@
+#ifndef QR_READER_MAPPED_FILE_H
+#define QR_READER_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Файл, отображённый в память только для чтения. Байты читаются прямо
+// из страничного кэша без промежуточного буфера; на платформах без mmap
+// файл целиком читается в память.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& file_path);
+    void close();
+
+    const unsigned char* data() const;
+    size_t size() const;
+    bool isOpen() const;
+    // true, если open() не удался из-за отсутствия файла
+    bool notFound() const;
+    const std::string& getError() const;
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    bool open_ = false;
+    bool not_found_ = false;
+    std::string error_;
+    std::vector<unsigned char> fallback_;
+};
+
+#endif // QR_READER_MAPPED_FILE_H
@@ -0,0 +1,430 @@
+#include "result_cache.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+namespace {
+
+const char* JOURNAL_FILE_NAME = "results.journal";
+// Журнал переписывается при открытии, если в нём не меньше стольких строк и мёртвых
+// (перекрытых, неудачных, битых) больше, чем живых
+const size_t COMPACT_MIN_LINES = 1024;
+
+inline uint64_t rotl64(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+inline uint64_t finalizeHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t mixWord(uint64_t h, uint64_t word) {
+    word *= 0x87c37b91114253d5ULL;
+    word = rotl64(word, 31);
+    word *= 0x4cf5ad432745937fULL;
+    h ^= word;
+    return rotl64(h, 27) * 5 + 0x52dce729;
+}
+
+uint64_t hashChunk(uint64_t h, const uchar* data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h = mixWord(h, word);
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, size - i);
+        h = mixWord(h, word);
+    }
+    return h;
+}
+
+std::string escapeField(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default:   escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+std::string unescapeField(const std::string& value) {
+    std::string plain;
+    plain.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            plain += value[i];
+            continue;
+        }
+        switch (value[++i]) {
+            case 't': plain += '\t'; break;
+            case 'n': plain += '\n'; break;
+            case 'r': plain += '\r'; break;
+            default:  plain += value[i]; break;
+        }
+    }
+    return plain;
+}
+
+std::string formatPoints(const std::vector<cv::Point>& points) {
+    std::string text;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (i > 0) text += ';';
+        text += std::to_string(points[i].x) + "," + std::to_string(points[i].y);
+    }
+    return text;
+}
+
+std::vector<cv::Point> parsePoints(const std::string& text) {
+    std::vector<cv::Point> points;
+    std::stringstream ss(text);
+    std::string pair;
+    while (std::getline(ss, pair, ';')) {
+        size_t comma = pair.find(',');
+        if (comma == std::string::npos) continue;
+        points.emplace_back(std::stoi(pair.substr(0, comma)), std::stoi(pair.substr(comma + 1)));
+    }
+    return points;
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+} // namespace
+
+double ResultCache::CacheStats::getHitRate() const {
+    int64_t lookups = memory_hits + disk_hits + misses;
+    if (lookups == 0) return 0.0;
+    return static_cast<double>(memory_hits + disk_hits) / lookups;
+}
+
+ResultCache::ResultCache() : ResultCache(Config()) {
+}
+
+ResultCache::ResultCache(const Config& config) : config_(config) {
+    if (config_.memory_capacity == 0) {
+        config_.memory_capacity = 1;
+    }
+    if (!config_.disk_directory.empty()) {
+        openJournal();
+    }
+}
+
+ResultCache::~ResultCache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (journal_.is_open()) {
+        journal_.flush();
+    }
+}
+
+uint64_t ResultCache::hashBytes(const uchar* data, size_t size) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (static_cast<uint64_t>(size) * 0xff51afd7ed558ccdULL);
+    return finalizeHash(hashChunk(h, data, size) ^ size);
+}
+
+uint64_t ResultCache::hashBytes(const std::vector<uchar>& bytes) {
+    return hashBytes(bytes.data(), bytes.size());
+}
+
+uint64_t ResultCache::hashImage(const cv::Mat& image) {
+    // Геометрия и тип входят в ключ, чтобы разные раскладки одних байтов не совпали
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    h = mixWord(h, static_cast<uint64_t>(image.rows));
+    h = mixWord(h, static_cast<uint64_t>(image.cols));
+    h = mixWord(h, static_cast<uint64_t>(image.type()));
+
+    size_t row_bytes = image.cols * image.elemSize();
+    if (image.isContinuous()) {
+        h = hashChunk(h, image.ptr(), row_bytes * image.rows);
+    } else {
+        for (int y = 0; y < image.rows; ++y) {
+            h = hashChunk(h, image.ptr(y), row_bytes);
+        }
+    }
+    return finalizeHash(h);
+}
+
+uint64_t ResultCache::hashString(const std::string& text) {
+    return hashBytes(reinterpret_cast<const uchar*>(text.data()), text.size());
+}
+
+uint64_t ResultCache::combineKey(uint64_t content_hash, uint64_t config_fingerprint) {
+    return finalizeHash(mixWord(content_hash, config_fingerprint));
+}
+
+bool ResultCache::lookup(uint64_t key, QRDetector::DetectionResult& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = lru_index_.find(key);
+    if (it != lru_index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        result = it->second->second;
+        stats_.memory_hits++;
+        return true;
+    }
+
+    auto disk_it = disk_index_.find(key);
+    if (disk_it != disk_index_.end() && readJournalEntry(disk_it->second, result)) {
+        insertMemory(key, result);
+        stats_.disk_hits++;
+        return true;
+    }
+
+    stats_.misses++;
+    return false;
+}
+
+void ResultCache::insert(uint64_t key, const QRDetector::DetectionResult& result) {
+    QRDetector::DetectionResult stored = result;
+    stored.processed_image.release();
+    // Попадание в кэш — новая выдача результата, время ставит писатель
+    stored.detected_at = {};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insertMemory(key, stored);
+    stats_.inserts++;
+
+    // Отрицательный результат живёт только в памяти текущего процесса
+    if (stored.success && journal_.is_open() && disk_index_.find(key) == disk_index_.end()) {
+        journal_.clear();
+        journal_.seekp(0, std::ios::end);
+        // После неудачной дозаписи в конце мог остаться обрывок строки — начинаем с новой
+        if (journal_needs_newline_) {
+            journal_ << '\n';
+        }
+        std::streamoff offset = journal_.tellp();
+        journal_ << serialize(key, stored) << '\n';
+        if (journal_) {
+            disk_index_[key] = offset;
+            journal_needs_newline_ = false;
+        } else {
+            QR_LOG_ERROR("Failed to append to result cache journal: " + journal_path_);
+            journal_needs_newline_ = true;
+        }
+    }
+}
+
+ResultCache::CacheStats ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t ResultCache::getMemorySize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+void ResultCache::openJournal() {
+    std::error_code ec;
+    std::filesystem::create_directories(config_.disk_directory, ec);
+    journal_path_ = (std::filesystem::path(config_.disk_directory) / JOURNAL_FILE_NAME).string();
+
+    // Создаём файл, если его ещё нет
+    std::ofstream(journal_path_, std::ios::app | std::ios::binary).close();
+
+    size_t lines = 0;
+    std::streamoff complete_size = 0;
+    {
+        std::ifstream in(journal_path_, std::ios::binary);
+        std::string line;
+        while (std::getline(in, line)) {
+            // Строка без '\n' в конце — запись, оборванная падением процесса
+            if (in.eof()) break;
+
+            uint64_t key = 0;
+            QRDetector::DetectionResult parsed;
+            if (!deserialize(line, key, parsed)) {
+                QR_LOG_WARNING("Skipping malformed cache journal line at offset " + std::to_string(complete_size));
+            } else if (parsed.success) {
+                // Неудачи, записанные прежними версиями, не подхватываем;
+                // более поздняя запись с тем же ключом перекрывает раннюю
+                disk_index_[key] = complete_size;
+            }
+            lines++;
+            complete_size += static_cast<std::streamoff>(line.size()) + 1;
+        }
+    }
+
+    // Обрывок отрезаем, иначе следующая дозапись склеится с ним в одну строку
+    uintmax_t file_size = std::filesystem::file_size(journal_path_, ec);
+    if (!ec && file_size > static_cast<uintmax_t>(complete_size)) {
+        QR_LOG_WARNING("Truncating partial record at the end of result cache journal: " + journal_path_);
+        std::filesystem::resize_file(journal_path_, static_cast<uintmax_t>(complete_size), ec);
+        if (ec) {
+            QR_LOG_ERROR("Failed to truncate result cache journal: " + ec.message());
+            journal_needs_newline_ = true;
+        }
+    }
+
+    if (lines >= COMPACT_MIN_LINES && lines - disk_index_.size() > disk_index_.size()) {
+        compactJournal(lines);
+    }
+
+    journal_.open(journal_path_, std::ios::in | std::ios::out | std::ios::binary);
+    if (!journal_.is_open()) {
+        QR_LOG_ERROR("Failed to open result cache journal: " + journal_path_);
+        disk_index_.clear();
+        return;
+    }
+
+    QR_LOG_INFO("Result cache journal loaded: " + std::to_string(disk_index_.size()) +
+                " entries from " + journal_path_);
+}
+
+bool ResultCache::compactJournal(size_t lines) {
+    // Живые записи переносим в порядке следования в файле, чтобы читать его последовательно
+    std::vector<std::pair<std::streamoff, uint64_t>> live;
+    live.reserve(disk_index_.size());
+    for (const auto& entry : disk_index_) {
+        live.emplace_back(entry.second, entry.first);
+    }
+    std::sort(live.begin(), live.end());
+
+    std::string compact_path = journal_path_ + ".compact";
+    std::unordered_map<uint64_t, std::streamoff> compacted;
+    {
+        std::ifstream in(journal_path_, std::ios::binary);
+        std::ofstream out(compact_path, std::ios::binary | std::ios::trunc);
+
+        std::string line;
+        std::streamoff offset = 0;
+        for (const auto& [old_offset, key] : live) {
+            in.seekg(old_offset);
+            if (!std::getline(in, line)) break;
+            out << line << '\n';
+            compacted[key] = offset;
+            offset += static_cast<std::streamoff>(line.size()) + 1;
+        }
+        out.flush();
+        if (!in || !out) {
+            compacted.clear();
+        }
+    }
+
+    std::error_code ec;
+    if (compacted.size() != live.size()) {
+        QR_LOG_WARNING("Result cache journal compaction failed, keeping " + journal_path_);
+        std::filesystem::remove(compact_path, ec);
+        return false;
+    }
+
+    // Замена переименованием: при падении на любом шаге остаётся целый старый или новый журнал
+    std::filesystem::rename(compact_path, journal_path_, ec);
+    if (ec) {
+        QR_LOG_WARNING("Failed to replace result cache journal: " + ec.message());
+        std::filesystem::remove(compact_path, ec);
+        return false;
+    }
+
+    disk_index_.swap(compacted);
+    QR_LOG_INFO("Result cache journal compacted: " + std::to_string(lines) + " -> " +
+                std::to_string(disk_index_.size()) + " lines");
+    return true;
+}
+
+void ResultCache::insertMemory(uint64_t key, const QRDetector::DetectionResult& result) {
+    auto it = lru_index_.find(key);
+    if (it != lru_index_.end()) {
+        it->second->second = result;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.emplace_front(key, result);
+    lru_index_[key] = lru_.begin();
+
+    if (lru_.size() > config_.memory_capacity) {
+        lru_index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+bool ResultCache::readJournalEntry(std::streamoff offset, QRDetector::DetectionResult& result) {
+    journal_.clear();
+    journal_.seekg(offset);
+
+    std::string line;
+    if (!std::getline(journal_, line)) {
+        journal_.clear();
+        return false;
+    }
+
+    uint64_t key = 0;
+    return deserialize(line, key, result);
+}
+
+std::string ResultCache::serialize(uint64_t key, const QRDetector::DetectionResult& result) {
+    std::ostringstream line;
+    line.precision(17);
+    line << std::hex << key << std::dec << '\t'
+         << (result.success ? 1 : 0) << '\t'
+         << result.confidence << '\t'
+         << formatPoints(result.bounding_box) << '\t'
+         << escapeField(result.preprocessing_stage) << '\t'
+         << escapeField(result.data) << '\t'
+         << escapeField(result.error_message);
+
+    for (const auto& code : result.codes) {
+        line << '\t' << escapeField(code.data)
+             << '\t' << code.confidence
+             << '\t' << formatPoints(code.bounding_box);
+    }
+
+    return line.str();
+}
+
+bool ResultCache::deserialize(const std::string& line, uint64_t& key, QRDetector::DetectionResult& result) {
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.size() < 7 || (fields.size() - 7) % 3 != 0) {
+        return false;
+    }
+
+    try {
+        QRDetector::DetectionResult parsed;
+        key = std::stoull(fields[0], nullptr, 16);
+        parsed.success = fields[1] == "1";
+        parsed.confidence = std::stod(fields[2]);
+        parsed.bounding_box = parsePoints(fields[3]);
+        parsed.preprocessing_stage = unescapeField(fields[4]);
+        parsed.data = unescapeField(fields[5]);
+        parsed.error_message = unescapeField(fields[6]);
+
+        for (size_t i = 7; i + 2 < fields.size(); i += 3) {
+            QRDetector::CodeResult code;
+            code.data = unescapeField(fields[i]);
+            code.confidence = std::stod(fields[i + 1]);
+            code.bounding_box = parsePoints(fields[i + 2]);
+            parsed.codes.push_back(std::move(code));
+        }
+
+        result = std::move(parsed);
+        return true;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
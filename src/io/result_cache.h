@@ -0,0 +1,82 @@
+#ifndef QR_READER_RESULT_CACHE_H
+#define QR_READER_RESULT_CACHE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../core/qr_detector.h"
+
+// Кэш результатов детекции с адресацией по содержимому.
+// Ключ — 64-битный хэш сырых байтов файла (или декодированных пикселей),
+// смешанный с отпечатком настроек детектора через combineKey, — результат
+// зависит и от того, и от другого. Значение — DetectionResult без изображения.
+// Два уровня: LRU в памяти и журнал на диске, который переживает перезапуск
+// процесса. Неудачи в журнал не пишутся: другая сборка или более сильный
+// каскад могут прочитать тот же файл. При открытии оборванная последняя строка
+// отрезается, а журнал, где мёртвые записи преобладают, переписывается заново.
+class ResultCache {
+public:
+    struct Config {
+        size_t memory_capacity = 4096;  // записей в LRU
+        std::string disk_directory;     // пусто = только память
+    };
+
+    struct CacheStats {
+        int64_t memory_hits = 0;
+        int64_t disk_hits = 0;
+        int64_t misses = 0;
+        int64_t inserts = 0;
+
+        double getHitRate() const;
+    };
+
+    ResultCache();
+    explicit ResultCache(const Config& config);
+    ~ResultCache();
+
+    static uint64_t hashBytes(const uchar* data, size_t size);
+    static uint64_t hashBytes(const std::vector<uchar>& bytes);
+    static uint64_t hashImage(const cv::Mat& image);
+    static uint64_t hashString(const std::string& text);
+    // Ключ записи: хэш содержимого, привязанный к отпечатку настроек детектора
+    static uint64_t combineKey(uint64_t content_hash, uint64_t config_fingerprint);
+
+    bool lookup(uint64_t key, QRDetector::DetectionResult& result);
+    void insert(uint64_t key, const QRDetector::DetectionResult& result);
+
+    CacheStats getStats() const;
+    size_t getMemorySize() const;
+
+private:
+    using LruList = std::list<std::pair<uint64_t, QRDetector::DetectionResult>>;
+
+    Config config_;
+    mutable std::mutex mutex_;
+
+    LruList lru_;
+    std::unordered_map<uint64_t, LruList::iterator> lru_index_;
+
+    // Смещения строк журнала; сами записи читаются с диска по требованию
+    std::unordered_map<uint64_t, std::streamoff> disk_index_;
+    std::fstream journal_;
+    std::string journal_path_;
+    bool journal_needs_newline_ = false;
+
+    CacheStats stats_;
+
+    void openJournal();
+    // Переписывает журнал, оставляя только записи из disk_index_
+    bool compactJournal(size_t lines);
+    void insertMemory(uint64_t key, const QRDetector::DetectionResult& result);
+    bool readJournalEntry(std::streamoff offset, QRDetector::DetectionResult& result);
+
+    static std::string serialize(uint64_t key, const QRDetector::DetectionResult& result);
+    static bool deserialize(const std::string& line, uint64_t& key, QRDetector::DetectionResult& result);
+};
+
+#endif // QR_READER_RESULT_CACHE_H
@@ -0,0 +1,378 @@
+#include "result_stream_writer.h"
+#include "result_writer.h"
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* CSV_HEADER = "timestamp,source,success,data,confidence,stage,codes,bounding_box,"
+                         "preprocess_ms,detect_ms,confidence_ms,error\n";
+
+void appendNumber(std::string& out, double value, int precision) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    out += buffer;
+}
+
+// Длина корректной UTF-8 последовательности, начинающейся с pos, или 0
+size_t utf8SequenceLength(const std::string& value, size_t pos) {
+    const auto byte = [&](size_t i) { return static_cast<unsigned char>(value[i]); };
+    unsigned char lead = byte(pos);
+    size_t length;
+    uint32_t code_point;
+    if (lead < 0x80) return 1;
+    if (lead >= 0xC2 && lead <= 0xDF) { length = 2; code_point = lead & 0x1F; }
+    else if (lead >= 0xE0 && lead <= 0xEF) { length = 3; code_point = lead & 0x0F; }
+    else if (lead >= 0xF0 && lead <= 0xF4) { length = 4; code_point = lead & 0x07; }
+    else return 0;
+
+    if (pos + length > value.size()) return 0;
+    for (size_t i = 1; i < length; ++i) {
+        if ((byte(pos + i) & 0xC0) != 0x80) return 0;
+        code_point = (code_point << 6) | (byte(pos + i) & 0x3F);
+    }
+    // Избыточные формы, суррогаты и значения за пределами Unicode
+    if ((length == 3 && code_point < 0x800) || (length == 4 && code_point < 0x10000) ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF) || code_point > 0x10FFFF) {
+        return 0;
+    }
+    return length;
+}
+
+bool isValidUtf8(const std::string& value) {
+    for (size_t pos = 0; pos < value.size();) {
+        size_t length = utf8SequenceLength(value, pos);
+        if (length == 0) return false;
+        pos += length;
+    }
+    return true;
+}
+
+void appendBase64(std::string& out, const std::string& value) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    for (; i + 3 <= value.size(); i += 3) {
+        uint32_t triple = (static_cast<unsigned char>(value[i]) << 16) |
+                          (static_cast<unsigned char>(value[i + 1]) << 8) |
+                          static_cast<unsigned char>(value[i + 2]);
+        out += ALPHABET[(triple >> 18) & 0x3F];
+        out += ALPHABET[(triple >> 12) & 0x3F];
+        out += ALPHABET[(triple >> 6) & 0x3F];
+        out += ALPHABET[triple & 0x3F];
+    }
+    if (i < value.size()) {
+        uint32_t triple = static_cast<unsigned char>(value[i]) << 16;
+        if (i + 1 < value.size()) triple |= static_cast<unsigned char>(value[i + 1]) << 8;
+        out += ALPHABET[(triple >> 18) & 0x3F];
+        out += ALPHABET[(triple >> 12) & 0x3F];
+        out += i + 1 < value.size() ? ALPHABET[(triple >> 6) & 0x3F] : '=';
+        out += '=';
+    }
+}
+
+// Некорректные байты UTF-8 заменяются на U+FFFD: строка JSON обязана быть UTF-8
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (size_t pos = 0; pos < value.size();) {
+        unsigned char c = static_cast<unsigned char>(value[pos]);
+        if (c >= 0x80) {
+            size_t length = utf8SequenceLength(value, pos);
+            if (length == 0) {
+                out += "\\ufffd";
+                pos++;
+            } else {
+                out.append(value, pos, length);
+                pos += length;
+            }
+            continue;
+        }
+        pos++;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+// Данные кода: строкой, если это UTF-8, иначе исходные байты в base64
+void appendJsonData(std::string& out, const std::string& data) {
+    if (isValidUtf8(data)) {
+        out += "\"data\":";
+        appendJsonString(out, data);
+    } else {
+        out += "\"data_base64\":\"";
+        appendBase64(out, data);
+        out += '"';
+    }
+}
+
+void appendJsonPoints(std::string& out, const std::vector<cv::Point>& points) {
+    out += '[';
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (i > 0) out += ',';
+        out += '[' + std::to_string(points[i].x) + ',' + std::to_string(points[i].y) + ']';
+    }
+    out += ']';
+}
+
+// Поле CSV по RFC 4180: кавычки только при необходимости, внутренние удваиваются
+void appendCsvField(std::string& out, const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+ResultStreamWriter::ResultStreamWriter() : ResultStreamWriter(Config()) {
+}
+
+ResultStreamWriter::ResultStreamWriter(const Config& config) : config_(config) {
+}
+
+ResultStreamWriter::~ResultStreamWriter() {
+    close();
+}
+
+bool ResultStreamWriter::open() {
+    if (file_) return true;
+
+    file_ = std::fopen(config_.path.c_str(), config_.append ? "ab" : "wb");
+    if (!file_) {
+        error_ = "Failed to open results file: " + config_.path;
+        QR_LOG_ERROR(error_);
+        return false;
+    }
+
+    // Буферизацию делаем сами — у FILE* она только удвоила бы копирование
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+    buffer_.reserve(config_.buffer_bytes + 4096);
+    last_flush_ = std::chrono::steady_clock::now();
+
+    // Заголовок CSV пишется только в пустой файл
+    if (config_.format == CSV) {
+        std::fseek(file_, 0, SEEK_END);
+        if (std::ftell(file_) == 0) {
+            buffer_ += CSV_HEADER;
+        }
+    }
+
+    QR_LOG_INFO("Streaming results to: " + config_.path);
+    return true;
+}
+
+bool ResultStreamWriter::isOpen() const {
+    return file_ != nullptr;
+}
+
+void ResultStreamWriter::close() {
+    if (!file_) return;
+    checkpoint();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void ResultStreamWriter::write(const std::string& source, const QRDetector::DetectionResult& result) {
+    write(source, result, detectionTimeOf(result));
+}
+
+void ResultStreamWriter::write(const std::string& source, const QRDetector::DetectionResult& result,
+                               std::chrono::system_clock::time_point time) {
+    if (!file_) return;
+    ScopedTimer timer("ResultStreamWriter::write");
+
+    appendRecord(buffer_, config_.format, source, result, time);
+    stats_.records++;
+    records_since_checkpoint_++;
+
+    if (config_.checkpoint_records > 0 && records_since_checkpoint_ >= config_.checkpoint_records) {
+        checkpoint();
+    } else if (config_.flush_each_record || buffer_.size() >= config_.buffer_bytes ||
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - last_flush_).count() >=
+                   config_.flush_interval_seconds) {
+        flush();
+    }
+}
+
+bool ResultStreamWriter::flush() {
+    if (!file_) return false;
+    last_flush_ = std::chrono::steady_clock::now();
+    if (buffer_.empty()) return true;
+
+    size_t written = std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    stats_.bytes_written += static_cast<int64_t>(written);
+    stats_.flushes++;
+    bool ok = written == buffer_.size();
+    buffer_.clear();
+
+    if (!ok) {
+        error_ = "Failed to write results file: " + config_.path;
+        QR_LOG_ERROR(error_);
+    }
+    return ok;
+}
+
+bool ResultStreamWriter::checkpoint() {
+    if (!flush()) return false;
+    records_since_checkpoint_ = 0;
+    stats_.checkpoints++;
+#ifdef __unix__
+    if (::fsync(fileno(file_)) != 0) {
+        error_ = "fsync failed for results file: " + config_.path;
+        QR_LOG_ERROR(error_);
+        return false;
+    }
+#endif
+    return true;
+}
+
+const ResultStreamWriter::WriterStats& ResultStreamWriter::getStats() const {
+    return stats_;
+}
+
+const std::string& ResultStreamWriter::getError() const {
+    return error_;
+}
+
+bool ResultStreamWriter::parseFormat(const std::string& name, Format& format) {
+    if (name == "jsonl" || name == "json") {
+        format = JSONL;
+    } else if (name == "csv") {
+        format = CSV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+ResultStreamWriter::Format ResultStreamWriter::formatForPath(const std::string& path) {
+    size_t dot = path.rfind('.');
+    Format format = JSONL;
+    if (dot != std::string::npos) {
+        parseFormat(path.substr(dot + 1), format);
+    }
+    return format;
+}
+
+std::chrono::system_clock::time_point ResultStreamWriter::detectionTimeOf(
+        const QRDetector::DetectionResult& result) {
+    if (result.detected_at.time_since_epoch().count() != 0) {
+        return result.detected_at;
+    }
+    return std::chrono::system_clock::now();
+}
+
+void ResultStreamWriter::appendRecord(std::string& out, Format format, const std::string& source,
+                                      const QRDetector::DetectionResult& result,
+                                      std::chrono::system_clock::time_point time) {
+    if (format == CSV) {
+        appendCsv(out, source, result, time);
+    } else {
+        appendJson(out, source, result, time);
+    }
+}
+
+void ResultStreamWriter::appendJson(std::string& out, const std::string& source,
+                                    const QRDetector::DetectionResult& result,
+                                    std::chrono::system_clock::time_point time) {
+    out += "{\"timestamp\":";
+    appendJsonString(out, ResultWriter::formatTimestamp(time));
+    out += ",\"source\":";
+    appendJsonString(out, source);
+    out += result.success ? ",\"success\":true" : ",\"success\":false";
+
+    if (result.success) {
+        out += ',';
+        appendJsonData(out, result.data);
+        out += ",\"confidence\":";
+        appendNumber(out, result.confidence, 4);
+        out += ",\"stage\":";
+        appendJsonString(out, result.preprocessing_stage);
+        out += ",\"bounding_box\":";
+        appendJsonPoints(out, result.bounding_box);
+
+        if (!result.codes.empty()) {
+            out += ",\"codes\":[";
+            for (size_t i = 0; i < result.codes.size(); ++i) {
+                if (i > 0) out += ',';
+                out += '{';
+                appendJsonData(out, result.codes[i].data);
+                out += ",\"confidence\":";
+                appendNumber(out, result.codes[i].confidence, 4);
+                out += ",\"bounding_box\":";
+                appendJsonPoints(out, result.codes[i].bounding_box);
+                out += '}';
+            }
+            out += ']';
+        }
+    } else {
+        out += ",\"error\":";
+        appendJsonString(out, result.error_message);
+    }
+
+    out += ",\"timings_ms\":{\"preprocess\":";
+    appendNumber(out, result.timings.preprocess_ms, 3);
+    out += ",\"detect\":";
+    appendNumber(out, result.timings.detect_ms, 3);
+    out += ",\"confidence\":";
+    appendNumber(out, result.timings.confidence_ms, 3);
+    out += "}}\n";
+}
+
+void ResultStreamWriter::appendCsv(std::string& out, const std::string& source,
+                                   const QRDetector::DetectionResult& result,
+                                   std::chrono::system_clock::time_point time) {
+    out += ResultWriter::formatTimestamp(time);
+    out += ',';
+    appendCsvField(out, source);
+    out += result.success ? ",1," : ",0,";
+    appendCsvField(out, result.data);
+    out += ',';
+    if (result.success) appendNumber(out, result.confidence, 4);
+    out += ',';
+    appendCsvField(out, result.preprocessing_stage);
+    out += ',';
+    out += std::to_string(result.codes.empty() ? (result.success ? 1 : 0) : result.codes.size());
+    out += ',';
+
+    // Точки рамки в одном поле: x1 y1;x2 y2;...
+    std::string points;
+    for (size_t i = 0; i < result.bounding_box.size(); ++i) {
+        if (i > 0) points += ';';
+        points += std::to_string(result.bounding_box[i].x) + ' ' + std::to_string(result.bounding_box[i].y);
+    }
+    out += points;
+    out += ',';
+
+    appendNumber(out, result.timings.preprocess_ms, 3);
+    out += ',';
+    appendNumber(out, result.timings.detect_ms, 3);
+    out += ',';
+    appendNumber(out, result.timings.confidence_ms, 3);
+    out += ',';
+    appendCsvField(out, result.success ? std::string() : result.error_message);
+    out += '\n';
+}
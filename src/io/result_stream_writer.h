@@ -0,0 +1,93 @@
+#ifndef QR_READER_RESULT_STREAM_WRITER_H
+#define QR_READER_RESULT_STREAM_WRITER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "../core/qr_detector.h"
+
+// Потоковая запись результатов в один файл JSON Lines или CSV.
+// Записи копятся в буфере и сбрасываются одной операцией при заполнении буфера
+// или по таймеру; fsync выполняется только в контрольных точках и при закрытии.
+// Не потокобезопасен: пишет один поток (стадия вывода конвейера).
+class ResultStreamWriter {
+public:
+    enum Format {
+        JSONL,
+        CSV
+    };
+
+    struct Config {
+        std::string path;
+        Format format = JSONL;
+        size_t buffer_bytes = 1 << 20;          // сброс при заполнении
+        double flush_interval_seconds = 1.0;    // и не реже, чем раз в интервал (проверяется в write)
+        // Низкий темп записей (поток, где пишется только смена кода): сброс после каждой,
+        // иначе запись может пролежать в буфере до close()
+        bool flush_each_record = false;
+        int checkpoint_records = 10000;         // fsync каждые N записей, 0 = только при закрытии
+        bool append = true;                     // дописывать в существующий файл
+    };
+
+    struct WriterStats {
+        int64_t records = 0;
+        int64_t bytes_written = 0;
+        int64_t flushes = 0;
+        int64_t checkpoints = 0;
+    };
+
+    ResultStreamWriter();
+    explicit ResultStreamWriter(const Config& config);
+    ~ResultStreamWriter();
+
+    ResultStreamWriter(const ResultStreamWriter&) = delete;
+    ResultStreamWriter& operator=(const ResultStreamWriter&) = delete;
+
+    bool open();
+    bool isOpen() const;
+    void close();
+
+    // time — момент детекции; по умолчанию result.detected_at, а если он пуст — текущее время
+    void write(const std::string& source, const QRDetector::DetectionResult& result);
+    void write(const std::string& source, const QRDetector::DetectionResult& result,
+               std::chrono::system_clock::time_point time);
+
+    bool flush();
+    // Сброс буфера и fsync: всё записанное до вызова переживёт падение машины
+    bool checkpoint();
+
+    const WriterStats& getStats() const;
+    const std::string& getError() const;
+
+    // Формат по имени ("jsonl", "csv") или по расширению пути
+    static bool parseFormat(const std::string& name, Format& format);
+    static Format formatForPath(const std::string& path);
+
+    static std::chrono::system_clock::time_point detectionTimeOf(const QRDetector::DetectionResult& result);
+
+    // Одна запись с завершающим \n без заголовка CSV — тот же формат для ответов сервиса.
+    // Данные кода, не являющиеся корректным UTF-8 (Shift-JIS, двоичный режим), в JSON
+    // пишутся полем data_base64 вместо data
+    static void appendRecord(std::string& out, Format format, const std::string& source,
+                             const QRDetector::DetectionResult& result,
+                             std::chrono::system_clock::time_point time);
+
+private:
+    Config config_;
+    std::FILE* file_ = nullptr;
+    std::string buffer_;
+    std::chrono::steady_clock::time_point last_flush_;
+    int64_t records_since_checkpoint_ = 0;
+    WriterStats stats_;
+    std::string error_;
+
+    static void appendJson(std::string& out, const std::string& source,
+                           const QRDetector::DetectionResult& result,
+                           std::chrono::system_clock::time_point time);
+    static void appendCsv(std::string& out, const std::string& source,
+                          const QRDetector::DetectionResult& result,
+                          std::chrono::system_clock::time_point time);
+};
+
+#endif // QR_READER_RESULT_STREAM_WRITER_H
@@ -1,57 +1,79 @@
 #include "result_writer.h"
 #include "../utils/logger.h"
+#include "../utils/profiler.h"
+#include <cstdio>
+#include <ctime>
 #include <fstream>
 #include <iomanip>
 
 bool ResultWriter::saveToTextFile(const QRDetector::DetectionResult& result,
                                  const std::string& filename) {
-    Logger::startOperation("Saving results to text file: " + filename);
+    ScopedTimer timer("ResultWriter::saveToTextFile");
 
     std::ofstream file(filename);
     if (!file.is_open()) {
-        Logger::error("Failed to open file for writing: " + filename);
+        QR_LOG_ERROR("Failed to open file for writing: " + filename);
         return false;
     }
 
     file << formatResult(result);
     file.close();
 
-    Logger::info("Results saved to: " + filename);
-    Logger::endOperation("Saving results to text file");
+    QR_LOG_INFO("Results saved to: " + filename);
 
     return true;
 }
 
 bool ResultWriter::saveVisualization(const QRDetector::DetectionResult& result,
                                    const std::string& filename) {
-    if (!result.success || result.processed_image.empty()) {
-        Logger::warning("Cannot save visualization - no successful result or empty image");
+    return saveVisualization(result, result.processed_image, filename);
+}
+
+bool ResultWriter::saveVisualization(const QRDetector::DetectionResult& result,
+                                   const cv::Mat& image,
+                                   const std::string& filename) {
+    if (!result.success || image.empty()) {
+        QR_LOG_WARNING("Cannot save visualization - no successful result or empty image");
         return false;
     }
 
-    Logger::startOperation("Saving visualization: " + filename);
-
-    cv::Mat visualization = result.processed_image.clone();
+    ScopedTimer timer("ResultWriter::saveVisualization");
 
-    if (result.bounding_box.size() == 4) {
-        drawBoundingBox(visualization, result.bounding_box);
+    // Единственная копия кадра за всю обработку — и только когда визуализация запрошена
+    cv::Mat visualization;
+    if (image.channels() == 1) {
+        cv::cvtColor(image, visualization, cv::COLOR_GRAY2BGR);
+    } else {
+        visualization = image.clone();
     }
 
-    drawInfoText(visualization, result);
+    drawOverlay(visualization, result);
 
     bool success = cv::imwrite(filename, visualization);
 
     if (success) {
-        Logger::info("Visualization saved to: " + filename);
+        QR_LOG_INFO("Visualization saved to: " + filename);
     } else {
-        Logger::error("Failed to save visualization: " + filename);
+        QR_LOG_ERROR("Failed to save visualization: " + filename);
     }
 
-    Logger::endOperation("Saving visualization");
-
     return success;
 }
 
+void ResultWriter::drawOverlay(cv::Mat& canvas, const QRDetector::DetectionResult& result) {
+    if (result.codes.size() > 1) {
+        for (const auto& code : result.codes) {
+            if (code.bounding_box.size() == 4) {
+                drawBoundingBox(canvas, code.bounding_box);
+            }
+        }
+    } else if (result.bounding_box.size() == 4) {
+        drawBoundingBox(canvas, result.bounding_box);
+    }
+
+    drawInfoText(canvas, result);
+}
+
 void ResultWriter::printToConsole(const QRDetector::DetectionResult& result) {
     std::cout << "\n" << std::string(50, '=') << std::endl;
     std::cout << "QR CODE DETECTION RESULT" << std::endl;
@@ -70,6 +92,15 @@ void ResultWriter::printToConsole(const QRDetector::DetectionResult& result) {
             }
             std::cout << std::endl;
         }
+
+        if (result.codes.size() > 1) {
+            std::cout << "Codes found: " << result.codes.size() << std::endl;
+            for (size_t i = 0; i < result.codes.size(); ++i) {
+                std::cout << "  [" << (i + 1) << "] " << result.codes[i].data
+                          << " (" << std::fixed << std::setprecision(2)
+                          << (result.codes[i].confidence * 100) << "%)" << std::endl;
+            }
+        }
     } else {
         std::cout << "Status: FAILED" << std::endl;
         std::cout << "Error: " << result.error_message << std::endl;
@@ -80,16 +111,16 @@ void ResultWriter::printToConsole(const QRDetector::DetectionResult& result) {
 
 bool ResultWriter::saveBatchResults(const std::vector<QRDetector::DetectionResult>& results,
                                   const std::string& base_filename) {
-    Logger::startOperation("Saving batch results");
+    ScopedTimer timer("ResultWriter::saveBatchResults");
 
     std::ofstream file(base_filename + "_batch.txt");
     if (!file.is_open()) {
-        Logger::error("Failed to create batch results file");
+        QR_LOG_ERROR("Failed to create batch results file");
         return false;
     }
 
     file << "BATCH QR CODE DETECTION RESULTS" << std::endl;
-    file << "Generated: " << __DATE__ << " " << __TIME__ << std::endl;
+    file << "Generated: " << formatTimestamp(std::chrono::system_clock::now()) << std::endl;
     file << "Total files processed: " << results.size() << std::endl;
     file << std::string(40, '-') << std::endl;
 
@@ -110,8 +141,7 @@ bool ResultWriter::saveBatchResults(const std::vector<QRDetector::DetectionResul
 
     file.close();
 
-    Logger::info("Batch results saved: " + base_filename + "_batch.txt");
-    Logger::endOperation("Saving batch results");
+    QR_LOG_INFO("Batch results saved: " + base_filename + "_batch.txt");
 
     return true;
 }
@@ -121,6 +151,24 @@ void ResultWriter::generateReport(const std::vector<QRDetector::DetectionResult>
     saveBatchResults(results, filename);
 }
 
+std::string ResultWriter::formatTimestamp(std::chrono::system_clock::time_point time) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      time.time_since_epoch()).count() % 1000);
+
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+
+    char buffer[32];
+    size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%03dZ", millis);
+    return buffer;
+}
+
 void ResultWriter::drawBoundingBox(cv::Mat& image, const std::vector<cv::Point>& bbox) {
     const cv::Scalar COLOR_GREEN(0, 255, 0);
     const cv::Scalar COLOR_RED(0, 0, 255);
@@ -210,11 +258,20 @@ std::string ResultWriter::formatResult(const QRDetector::DetectionResult& result
             }
             ss << std::endl;
         }
+
+        if (result.codes.size() > 1) {
+            ss << "  Codes: " << result.codes.size() << std::endl;
+            for (size_t i = 0; i < result.codes.size(); ++i) {
+                ss << "    [" << (i + 1) << "] " << result.codes[i].data
+                   << " (" << std::fixed << std::setprecision(1)
+                   << (result.codes[i].confidence * 100) << "%)" << std::endl;
+            }
+        }
     } else {
         ss << "  Error: " << result.error_message << std::endl;
     }
 
-    ss << "  Timestamp: " << __DATE__ << " " << __TIME__ << std::endl;
+    ss << "  Timestamp: " << formatTimestamp(std::chrono::system_clock::now()) << std::endl;
 
     return ss.str();
 }
@@ -1,6 +1,7 @@
 #ifndef QR_READER_RESULT_WRITER_H
 #define QR_READER_RESULT_WRITER_H
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <opencv2/opencv.hpp>
@@ -14,6 +15,15 @@ public:
     static bool saveVisualization(const QRDetector::DetectionResult& result,
                                  const std::string& filename);
 
+    // Для результатов без сохранённого кадра: рисуем поверх переданного изображения
+    static bool saveVisualization(const QRDetector::DetectionResult& result,
+                                 const cv::Mat& image,
+                                 const std::string& filename);
+
+    // Рамки кодов и подписи поверх готового BGR-холста; координаты результата —
+    // в системе холста. Общая часть saveVisualization и VisualizationRenderer
+    static void drawOverlay(cv::Mat& canvas, const QRDetector::DetectionResult& result);
+
     static void printToConsole(const QRDetector::DetectionResult& result);
 
     static bool saveBatchResults(const std::vector<QRDetector::DetectionResult>& results,
@@ -22,6 +32,9 @@ public:
     static void generateReport(const std::vector<QRDetector::DetectionResult>& results,
                               const std::string& filename);
 
+    // ISO 8601 в UTC с миллисекундами: 2024-05-17T09:41:07.123Z
+    static std::string formatTimestamp(std::chrono::system_clock::time_point time);
+
 private:
     static void drawBoundingBox(cv::Mat& image, const std::vector<cv::Point>& bbox);
     static void drawInfoText(cv::Mat& image, const QRDetector::DetectionResult& result);
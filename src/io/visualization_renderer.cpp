@@ -0,0 +1,215 @@
+#include "visualization_renderer.h"
+#include "result_writer.h"
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace {
+
+void mapPoints(std::vector<cv::Point>& points, cv::Point origin, double scale) {
+    for (auto& point : points) {
+        point = cv::Point(cvRound((point.x - origin.x) * scale), cvRound((point.y - origin.y) * scale));
+    }
+}
+
+void collectPoints(const QRDetector::DetectionResult& result, std::vector<cv::Point>& points) {
+    points.insert(points.end(), result.bounding_box.begin(), result.bounding_box.end());
+    for (const auto& code : result.codes) {
+        points.insert(points.end(), code.bounding_box.begin(), code.bounding_box.end());
+    }
+}
+
+} // namespace
+
+VisualizationRenderer::VisualizationRenderer() : VisualizationRenderer(Config()) {
+}
+
+VisualizationRenderer::VisualizationRenderer(const Config& config)
+    : config_(config), queue_(config.queue_capacity) {
+    int threads = std::max(1, config_.num_threads);
+    for (int i = 0; i < threads; ++i) {
+        workers_.emplace_back(&VisualizationRenderer::renderLoop, this);
+    }
+}
+
+VisualizationRenderer::~VisualizationRenderer() {
+    close();
+}
+
+bool VisualizationRenderer::submit(const QRDetector::DetectionResult& result, const std::string& base_name) {
+    return submit(result, result.processed_image, base_name);
+}
+
+bool VisualizationRenderer::submit(const QRDetector::DetectionResult& result, const cv::Mat& image,
+                                   const std::string& base_name) {
+    if (!result.success || image.empty()) {
+        QR_LOG_WARNING("Cannot save visualization - no successful result or empty image");
+        return false;
+    }
+
+    Job job;
+    job.result = result;
+    // Кадр едет отдельным заголовком, копия в результате не нужна
+    job.result.processed_image.release();
+    job.image = image;
+    job.file_name = base_name + getExtension();
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.submitted++;
+    }
+    return queue_.push(std::move(job));
+}
+
+void VisualizationRenderer::close() {
+    queue_.close();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+VisualizationRenderer::RenderStats VisualizationRenderer::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+std::string VisualizationRenderer::getExtension() const {
+    switch (config_.format) {
+        case JPEG: return ".jpg";
+        case WEBP: return ".webp";
+        default:   return ".png";
+    }
+}
+
+bool VisualizationRenderer::parseFormat(const std::string& name, Format& format) {
+    if (name == "png") {
+        format = PNG;
+    } else if (name == "jpeg" || name == "jpg") {
+        format = JPEG;
+    } else if (name == "webp") {
+        format = WEBP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+cv::Mat VisualizationRenderer::render(const QRDetector::DetectionResult& result, const cv::Mat& image,
+                                      const Config& config) {
+    if (!result.success || image.empty()) {
+        return cv::Mat();
+    }
+
+    cv::Rect roi(0, 0, image.cols, image.rows);
+    if (config.crop_to_code) {
+        std::vector<cv::Point> points;
+        collectPoints(result, points);
+        if (!points.empty()) {
+            cv::Rect bounds = cv::boundingRect(points);
+            int margin = cvRound(std::max(bounds.width, bounds.height) * config.crop_margin);
+            bounds.x -= margin;
+            bounds.y -= margin;
+            bounds.width += 2 * margin;
+            bounds.height += 2 * margin;
+            bounds &= roi;
+            if (bounds.area() > 0) {
+                roi = bounds;
+            }
+        }
+    }
+
+    double scale = 1.0;
+    int longest = std::max(roi.width, roi.height);
+    if (config.max_side > 0 && longest > config.max_side) {
+        scale = static_cast<double>(config.max_side) / longest;
+    }
+
+    // Обрезка — только заголовок; уменьшаем до копирования и перевода в BGR,
+    // чтобы дальше работать с миниатюрой, а не с полным кадром
+    cv::Mat view = image(roi);
+    cv::Mat scaled;
+    if (scale < 1.0) {
+        cv::resize(view, scaled, cv::Size(), scale, scale, cv::INTER_AREA);
+    } else {
+        scaled = view;
+    }
+
+    cv::Mat canvas;
+    if (scaled.channels() == 1) {
+        cv::cvtColor(scaled, canvas, cv::COLOR_GRAY2BGR);
+    } else if (scale >= 1.0) {
+        // Без уменьшения это всё ещё буфер вызывающего — рисовать по нему нельзя
+        canvas = scaled.clone();
+    } else {
+        canvas = scaled;
+    }
+
+    QRDetector::DetectionResult mapped = result;
+    mapped.processed_image.release();
+    mapPoints(mapped.bounding_box, roi.tl(), scale);
+    for (auto& code : mapped.codes) {
+        mapPoints(code.bounding_box, roi.tl(), scale);
+    }
+
+    ResultWriter::drawOverlay(canvas, mapped);
+    return canvas;
+}
+
+std::vector<int> VisualizationRenderer::encodeParams() const {
+    int quality = std::min(std::max(config_.quality, 1), 100);
+    switch (config_.format) {
+        case JPEG: return {cv::IMWRITE_JPEG_QUALITY, quality};
+        case WEBP: return {cv::IMWRITE_WEBP_QUALITY, quality};
+        default:   return {cv::IMWRITE_PNG_COMPRESSION, std::min(std::max(config_.png_compression, 0), 9)};
+    }
+}
+
+void VisualizationRenderer::renderLoop() {
+    const std::vector<int> params = encodeParams();
+    const std::string extension = getExtension();
+
+    Job job;
+    while (queue_.pop(job)) {
+        ScopedTimer timer("VisualizationRenderer::render");
+        auto start = std::chrono::steady_clock::now();
+
+        cv::Mat canvas = render(job.result, job.image, config_);
+        job.image.release();
+
+        std::vector<uchar> encoded;
+        bool success = false;
+        try {
+            success = !canvas.empty() && cv::imencode(extension, canvas, encoded, params);
+        } catch (const cv::Exception& e) {
+            QR_LOG_ERROR("Failed to encode visualization " + job.file_name + ": " + e.what());
+        }
+
+        if (success) {
+            std::ofstream file(job.file_name, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            success = static_cast<bool>(file);
+        }
+
+        if (success) {
+            QR_LOG_INFO("Visualization saved to: " + job.file_name);
+        } else {
+            QR_LOG_ERROR("Failed to save visualization: " + job.file_name);
+        }
+
+        double elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        if (success) {
+            stats_.written++;
+            stats_.bytes_written += static_cast<int64_t>(encoded.size());
+        } else {
+            stats_.failed++;
+        }
+        stats_.render_ms += elapsed_ms;
+    }
+}
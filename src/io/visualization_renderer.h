@@ -0,0 +1,88 @@
+#ifndef QR_READER_VISUALIZATION_RENDERER_H
+#define QR_READER_VISUALIZATION_RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/qr_detector.h"
+#include "../utils/bounded_queue.h"
+
+// Визуализация результатов в фоновых потоках.
+// Кадр сначала обрезается до области кодов и/или уменьшается, и только потом
+// копируется, размечается и кодируется — полный кадр не клонируется и не
+// кодируется в PNG, если этого не просили. Очередь ограничена: при её заполнении
+// submit() ждёт, так что кадров в памяти не больше queue_capacity.
+class VisualizationRenderer {
+public:
+    enum Format {
+        PNG,
+        JPEG,
+        WEBP
+    };
+
+    struct Config {
+        Format format = PNG;
+        int quality = 90;               // JPEG/WebP: 1..100; для PNG не используется
+        int png_compression = 1;        // 0..9, меньше — быстрее и крупнее файл
+        int max_side = 0;               // уменьшить до миниатюры с этой длинной стороной, 0 = исходный размер
+        bool crop_to_code = false;      // обрезать до четырёхугольников кодов с полями
+        double crop_margin = 0.25;      // поле вокруг кодов в долях стороны их охватывающего прямоугольника
+        int num_threads = 1;
+        size_t queue_capacity = 8;
+    };
+
+    struct RenderStats {
+        int64_t submitted = 0;
+        int64_t written = 0;
+        int64_t failed = 0;
+        int64_t bytes_written = 0;
+        double render_ms = 0.0;         // суммарно по фоновым потокам: подготовка, разметка, кодирование
+    };
+
+    VisualizationRenderer();
+    explicit VisualizationRenderer(const Config& config);
+    ~VisualizationRenderer();
+
+    VisualizationRenderer(const VisualizationRenderer&) = delete;
+    VisualizationRenderer& operator=(const VisualizationRenderer&) = delete;
+
+    // base_name — путь без расширения, расширение добавляется по формату.
+    // image — кадр, в системе координат которого лежат рамки результата;
+    // пиксели не копируются до фонового потока. false — результат нечего рисовать.
+    bool submit(const QRDetector::DetectionResult& result, const cv::Mat& image, const std::string& base_name);
+    bool submit(const QRDetector::DetectionResult& result, const std::string& base_name);
+
+    // Дожидается записи всего поставленного и останавливает потоки
+    void close();
+
+    RenderStats getStats() const;
+    std::string getExtension() const;
+
+    // Имя формата ("png", "jpeg"/"jpg", "webp")
+    static bool parseFormat(const std::string& name, Format& format);
+
+    // Холст визуализации без записи на диск: обрезка, уменьшение, разметка
+    static cv::Mat render(const QRDetector::DetectionResult& result, const cv::Mat& image, const Config& config);
+
+private:
+    struct Job {
+        QRDetector::DetectionResult result;
+        cv::Mat image;
+        std::string file_name;
+    };
+
+    Config config_;
+    BoundedQueue<Job> queue_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex stats_mutex_;
+    RenderStats stats_;
+
+    std::vector<int> encodeParams() const;
+    void renderLoop();
+};
+
+#endif // QR_READER_VISUALIZATION_RENDERER_H
@@ -1,70 +1,430 @@
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <vector>
+#include "qr_reader_config.h"
+#include "utils/arg_parser.h"
 #include "utils/logger.h"
-#include "io/image_loader.h"
-#include "core/qr_detector.h"
-#include "io/result_writer.h"
+#include "utils/profiler.h"
+#include "core/batch_processor.h"
+#include "core/stream_decoder.h"
+#include "processors/image_processor.h"
+#ifdef QR_READER_LINUX
+#include "service/decode_server.h"
+#endif
+#include "service/shutdown_signal.h"
+#include "service/spool_daemon.h"
 
-int main() {
-    std::cout << "=== QR Reader Complete System Test ===" << std::endl;
+// Опции, за которыми следует значение
+static bool optionTakesValue(const std::string& arg) {
+    static const std::vector<std::string> options = {
+        "--workers", "--decoders", "--queue", "--stages", "--stream", "--spool", "--done-dir",
+        "--failed-dir", "--max-frames", "--pace-fps", "--reduce", "--binarize", "--cache-dir", "--results",
+        "--results-format", "--viz-format", "--viz-quality", "--viz-thumbnail", "--debug-dir",
+        "--debug-rate", "--debug-budget-mb",
+#ifdef QR_READER_LINUX
+        "--serve", "--max-batch", "--batch-window-us",
+#endif
+    };
+    return std::find(options.begin(), options.end(), arg) != options.end();
+}
 
-    Logger::setLogLevel(Logger::INFO);
+// Настройки детектора из командной строки одинаковы во всех режимах — пакетном, спуле,
+// видеопотоке и сервисе; у каждого режима в Config поля с теми же именами.
+// Исключение — предобработка: в видеопотоке она выключена всегда, иначе каждый кадр без
+// кода проходил бы весь каскад
+template <typename ModeConfig>
+static void applyDetectorOptions(const BatchProcessor::Config& batch, ModeConfig& config) {
+    config.multiple_qr_enabled = batch.multiple_qr_enabled;
+    config.pyramid_localization = batch.pyramid_localization;
+    config.cascade_stages = batch.cascade_stages;
+    config.quality_gate_enabled = batch.quality_gate_enabled;
+    config.quality_gate = batch.quality_gate;
+}
 
-    Logger::info("Step 1: Loading image...");
+static void logCaptureStats(const DebugCapture::CaptureStats& capture) {
+    QR_LOG_INFO("  Debug captures written: " + std::to_string(capture.written) + " / " +
+                std::to_string(capture.sampled) + " sampled (" + std::to_string(capture.bytes_written) +
+                " bytes, dropped by queue " + std::to_string(capture.dropped_queue) + ", by budget " +
+                std::to_string(capture.dropped_budget) + ")");
+}
 
-    std::vector<ImageLoader::LoadResult> load_results;
+static void logGateStats(const QualityGate::GateStats& gate) {
+    QR_LOG_INFO("  Quality gate rejected: " + std::to_string(gate.frames_rejected) + " / " +
+                std::to_string(gate.frames_checked) + " (exposure " + std::to_string(gate.rejected_exposure) +
+                ", blank " + std::to_string(gate.rejected_blank) + ", blurry " +
+                std::to_string(gate.rejected_blurry) + ")");
+    QR_LOG_INFO("  Quality gate cost: " + std::to_string(gate.gate_ms) + " ms, estimated saved: " +
+                std::to_string(gate.getEstimatedSavedMs()) + " ms");
+}
 
-    std::vector<std::string> paths = {
-        "../test_images/qr1.png",
-        "../test_images/qr2.jpg",
-        "../test_images/qr3.jpg",
-        "../test_images/qr4.jpg",
-        "qr_code.png"
-    };
+static int runStream(const StreamDecoder::Config& config, ResultStreamWriter::Config results) {
+    QR_LOG_INFO("Streaming from source: " + config.source);
 
-    for (const auto& path : paths) {
-        auto load_result = ImageLoader::loadFromFile(path);
-        if (load_result.success) {
-            Logger::info("Successfully loaded from: " + path);
-            load_results.push_back(load_result);
-        } else {
-            Logger::error("No test image found by path: " + path + " Please add a QR code image to the project.");
+    // Пишется только смена содержимого — записи редкие, держать их в буфере незачем
+    results.flush_each_record = true;
+    ResultStreamWriter writer(results);
+    if (!results.path.empty() && !writer.open()) {
+        return 1;
+    }
+
+    // Ctrl-C останавливает захват, а писатель закрывается штатно
+    ShutdownSignal::install();
+    StreamDecoder decoder(config);
+    std::string last_data;
+    auto stats = decoder.run([&](const StreamDecoder::FrameResult& frame) {
+        if (ShutdownSignal::isRequested()) {
+            decoder.stop();
         }
+        // Печатаем и пишем только смену содержимого, а не каждый кадр с тем же кодом
+        if (frame.detection.success && frame.detection.data != last_data) {
+            last_data = frame.detection.data;
+            QR_LOG_INFO("Frame " + std::to_string(frame.frame_id) + ": " + frame.detection.data);
+            writer.write(config.source + "#" + std::to_string(frame.frame_id), frame.detection);
+        }
+    });
+    writer.close();
+
+    if (stats.frames_captured == 0) {
+        QR_LOG_ERROR("No frames received from source: " + config.source);
+        return 1;
+    }
+
+    QR_LOG_INFO("Stream statistics:");
+    QR_LOG_INFO("  Frames captured: " + std::to_string(stats.frames_captured));
+    QR_LOG_INFO("  Frames decoded: " + std::to_string(stats.frames_decoded));
+    QR_LOG_INFO("  Frames dropped: " + std::to_string(stats.frames_dropped));
+    QR_LOG_INFO("  Successful: " + std::to_string(stats.successful_decodes));
+    QR_LOG_INFO("  Capture fps: " + std::to_string(stats.getCaptureFps()));
+    QR_LOG_INFO("  Decode fps: " + std::to_string(stats.getDecodeFps()));
+    QR_LOG_INFO("  Latency avg/max: " + std::to_string(stats.avg_latency_ms) + " / " +
+                std::to_string(stats.max_latency_ms) + " ms");
+    if (config.tracking_enabled) {
+        QR_LOG_INFO("  Tracker full/window/reused: " + std::to_string(stats.tracker.full_searches) + " / " +
+                    std::to_string(stats.tracker.window_searches) + " / " +
+                    std::to_string(stats.tracker.reused_results));
+    }
+    if (config.quality_gate_enabled) {
+        logGateStats(stats.gate);
     }
+    if (config.debug_capture.enabled) {
+        logCaptureStats(stats.capture);
+    }
+    return 0;
+}
+
+static int runSpool(const BatchProcessor::Config& batch, SpoolDaemon::Config config) {
+    applyDetectorOptions(batch, config);
+    config.preprocessing_enabled = batch.preprocessing_enabled;
+    config.num_workers = batch.num_workers;
+    config.decode = batch.decode;
+    config.results = batch.results;
 
-    if (load_results.size() == 0) {
-        Logger::error("No test image found. Please add a QR code image to the project.");
+    ShutdownSignal::install();
+    SpoolDaemon daemon(config);
+    if (!daemon.run()) {
         return 1;
     }
 
-    Logger::info("Step 2: Initializing QR detector...");
-    QRDetector detector;
-    detector.setPreprocessingEnabled(true);
+    auto stats = daemon.getStats();
+    QR_LOG_INFO("Spool statistics:");
+    QR_LOG_INFO("  Files processed: " + std::to_string(stats.files_processed) + " (successful " +
+                std::to_string(stats.successful) + ", failed " + std::to_string(stats.failed) + ")");
+    QR_LOG_INFO("  Latency avg/max: " + std::to_string(stats.avg_latency_ms) + " / " +
+                std::to_string(stats.max_latency_ms) + " ms");
+    QR_LOG_INFO("  Uptime: " + std::to_string(stats.uptime_seconds) + " s");
+    return 0;
+}
+
+#ifdef QR_READER_LINUX
+static int runServer(const BatchProcessor::Config& batch, DecodeServer::Config config) {
+    applyDetectorOptions(batch, config);
+    config.preprocessing_enabled = batch.preprocessing_enabled;
+    config.num_workers = batch.num_workers;
+    config.grayscale = batch.decode.grayscale;
 
-    Logger::info("Step 3: Detecting QR code...");
-    std::vector<QRDetector::DetectionResult> detection_results;
-    for (const auto& load_result : load_results) {
-       auto detection_result = detector.detectFromImage(load_result.image);
-       detection_results.push_back(detection_result);
+    ShutdownSignal::install();
+    DecodeServer server(config);
+    if (!server.run()) {
+        return 1;
     }
 
-    int writer_counter = 1;
-    Logger::info("Step 4: Outputting results...");
-    for (const auto& detection : detection_results) {
-        ResultWriter::printToConsole(detection);
-        if (detection.success) {
-            ResultWriter::saveToTextFile(detection, "qr_result_" + std::to_string(writer_counter) + ".txt");
-            ResultWriter::saveVisualization(detection, "qr_visualization_" + std::to_string(writer_counter) + ".png");
-            Logger::info("Results saved to qr_result.txt and qr_visualization_" + std::to_string(writer_counter) + ".png");
-            writer_counter++;
+    auto stats = server.getStats();
+    QR_LOG_INFO("Server statistics:");
+    QR_LOG_INFO("  Connections: " + std::to_string(stats.connections) + ", requests: " +
+                std::to_string(stats.requests) + " (decoded " + std::to_string(stats.decoded) +
+                ", bad " + std::to_string(stats.bad_requests) + ")");
+    QR_LOG_INFO("  Connections rejected over limit: " + std::to_string(stats.rejected_connections) +
+                ", dropped on send timeout: " + std::to_string(stats.dropped_connections));
+    QR_LOG_INFO("  Batches: " + std::to_string(stats.batches) + ", average size " +
+                std::to_string(stats.avg_batch_size));
+    QR_LOG_INFO("  Latency avg/max: " + std::to_string(stats.avg_latency_ms) + " / " +
+                std::to_string(stats.max_latency_ms) + " ms");
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::cout << "=== QR Reader Complete System Test ===" << std::endl;
+
+    Logger::setLogLevel(Logger::INFO);
+
+    BatchProcessor::Config config;
+    StreamDecoder::Config stream_config;
+    SpoolDaemon::Config spool_config;
+#ifdef QR_READER_LINUX
+    DecodeServer::Config server_config;
+    bool server_mode = false;
+#endif
+    bool stream_mode = false;
+    bool results_format_set = false;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        // Опция без значения в конце строки не должна молча стать путём к изображению
+        if (optionTakesValue(arg) && i + 1 >= argc) {
+            QR_LOG_ERROR("Missing value for " + arg);
+            return 1;
+        }
+        if (arg == "--workers") {
+            if (!cli::parseIntArg(arg, argv[++i], 0, 1024, config.num_workers)) {
+                return 1;
+            }
+        } else if (arg == "--decoders") {
+            if (!cli::parseIntArg(arg, argv[++i], 0, 1024, config.num_decoders)) {
+                return 1;
+            }
+        } else if (arg == "--queue") {
+            if (!cli::parseIntArg(arg, argv[++i], 1, 65536, config.queue_capacity)) {
+                return 1;
+            }
+        } else if (arg == "--no-preprocessing") {
+            config.preprocessing_enabled = false;
+        } else if (arg == "--multi") {
+            config.multiple_qr_enabled = true;
+        } else if (arg == "--pyramid") {
+            config.pyramid_localization = true;
+        } else if (arg == "--stages") {
+            std::stringstream stages(argv[++i]);
+            std::string stage;
+            while (std::getline(stages, stage, ',')) {
+                config.cascade_stages.push_back(stage);
+            }
+        } else if (arg == "--stream") {
+            stream_mode = true;
+            stream_config.source = argv[++i];
+        } else if (arg == "--spool") {
+            spool_config.spool_directory = argv[++i];
+        } else if (arg == "--done-dir") {
+            spool_config.done_directory = argv[++i];
+        } else if (arg == "--failed-dir") {
+            spool_config.failed_directory = argv[++i];
+#ifdef QR_READER_LINUX
+        } else if (arg == "--serve") {
+            server_mode = true;
+            server_config.endpoint = argv[++i];
+        } else if (arg == "--max-batch") {
+            if (!cli::parseIntArg(arg, argv[++i], 1, 4096, server_config.max_batch)) {
+                return 1;
+            }
+        } else if (arg == "--batch-window-us") {
+            if (!cli::parseIntArg(arg, argv[++i], 0, 1000000, server_config.batch_window_us)) {
+                return 1;
+            }
+#endif
+        } else if (arg == "--max-frames") {
+            if (!cli::parseIntArg(arg, argv[++i], 0, std::numeric_limits<int>::max(), stream_config.max_frames)) {
+                return 1;
+            }
+        } else if (arg == "--track") {
+            stream_config.tracking_enabled = true;
+        } else if (arg == "--pace-fps") {
+            if (!cli::parseDoubleArg(arg, argv[++i], 0.0, 1000.0, stream_config.pace_fps)) {
+                return 1;
+            }
+        } else if (arg == "--reduce") {
+            // Встроенное уменьшение декодера JPEG бывает только 1/2, 1/4 и 1/8
+            int reduction = 0;
+            if (!cli::parseIntArg(arg, argv[++i], 1, 8, reduction)) {
+                return 1;
+            }
+            if (reduction != 1 && reduction != 2 && reduction != 4 && reduction != 8) {
+                QR_LOG_ERROR("Invalid value for --reduce: " + std::to_string(reduction) + " (expected 1, 2, 4 or 8)");
+                return 1;
+            }
+            config.decode.reduction = reduction;
+            config.decode.grayscale = true;
+        } else if (arg == "--gray") {
+            config.decode.grayscale = true;
+        } else if (arg == "--binarize") {
+            ImageProcessor::BinarizationMethod method;
+            if (!ImageProcessor::parseBinarizationMethod(argv[++i], method)) {
+                QR_LOG_ERROR(std::string("Unknown binarization method: ") + argv[i]);
+                return 1;
+            }
+            ImageProcessor::setBinarizationMethod(method);
+        } else if (arg == "--fused") {
+            ImageProcessor::setFusedEnhancement(true);
+        } else if (arg == "--quality-gate") {
+            config.quality_gate_enabled = true;
+        } else if (arg == "--cache") {
+            config.cache_enabled = true;
+        } else if (arg == "--cache-dir") {
+            config.cache_enabled = true;
+            config.cache.disk_directory = argv[++i];
+        } else if (arg == "--cache-pixels") {
+            config.cache_enabled = true;
+            config.cache_by_pixels = true;
+        } else if (arg == "--no-save") {
+            config.save_results = false;
+        } else if (arg == "--results") {
+            config.results.path = argv[++i];
+        } else if (arg == "--results-format") {
+            if (!ResultStreamWriter::parseFormat(argv[++i], config.results.format)) {
+                QR_LOG_ERROR(std::string("Unknown results format: ") + argv[i]);
+                return 1;
+            }
+            results_format_set = true;
+        } else if (arg == "--viz-format") {
+            if (!VisualizationRenderer::parseFormat(argv[++i], config.visualization.format)) {
+                QR_LOG_ERROR(std::string("Unknown visualization format: ") + argv[i]);
+                return 1;
+            }
+        } else if (arg == "--viz-quality") {
+            if (!cli::parseIntArg(arg, argv[++i], 1, 100, config.visualization.quality)) {
+                return 1;
+            }
+        } else if (arg == "--viz-thumbnail") {
+            if (!cli::parseIntArg(arg, argv[++i], 0, 65536, config.visualization.max_side)) {
+                return 1;
+            }
+        } else if (arg == "--viz-crop") {
+            config.visualization.crop_to_code = true;
+        } else if (arg == "--debug-dir") {
+            config.debug_capture.enabled = true;
+            config.debug_capture.directory = argv[++i];
+        } else if (arg == "--debug-rate") {
+            if (!cli::parseDoubleArg(arg, argv[++i], 0.0, 1.0, config.debug_capture.sample_rate)) {
+                return 1;
+            }
+        } else if (arg == "--debug-budget-mb") {
+            size_t budget_mb = 0;
+            if (!cli::parseIntArg(arg, argv[++i], 0, 1 << 20, budget_mb)) {
+                return 1;
+            }
+            config.debug_capture.max_total_bytes = budget_mb << 20;
+        } else if (arg == "--profile") {
+            Profiler::setEnabled(true);
+            Profiler::dumpAtExit();
+        } else if (arg == "--quiet") {
+            config.print_results = false;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            QR_LOG_ERROR("Unknown option: " + arg);
+            return 1;
+        } else {
+            paths.push_back(arg);
         }
     }
 
-    Logger::info("Detection statistics:");
-    Logger::info("  Total detections: " + std::to_string(detector.getTotalDetections()));
-    Logger::info("  Successful: " + std::to_string(detector.getSuccessfulDetections()));
-    Logger::info("  Success rate: " + std::to_string(static_cast<int>(detector.getSuccessRate() * 100)) + "%");
+    if (!config.results.path.empty() && !results_format_set) {
+        config.results.format = ResultStreamWriter::formatForPath(config.results.path);
+    }
+
+#ifdef QR_READER_LINUX
+    if (server_mode) {
+        return runServer(config, server_config);
+    }
+#endif
+
+    if (!spool_config.spool_directory.empty()) {
+        return runSpool(config, spool_config);
+    }
+
+    if (stream_mode) {
+        applyDetectorOptions(config, stream_config);
+        stream_config.grayscale = config.decode.grayscale;
+        stream_config.debug_capture = config.debug_capture;
+        return runStream(stream_config, config.results);
+    }
+
+    if (paths.empty()) {
+        paths = {
+            "../test_images/qr1.png",
+            "../test_images/qr2.jpg",
+            "../test_images/qr3.jpg",
+            "../test_images/qr4.jpg",
+            "qr_code.png"
+        };
+    }
+
+    QR_LOG_INFO("Step 1: Processing " + std::to_string(paths.size()) + " images...");
+    BatchProcessor processor(config);
+    auto stats = processor.process(paths);
+
+    if (stats.loaded_files == 0) {
+        QR_LOG_ERROR("No test image found. Please add a QR code image to the project.");
+        return 1;
+    }
+
+    QR_LOG_INFO("Detection statistics:");
+    QR_LOG_INFO("  Workers: " + std::to_string(stats.workers) +
+                " (decoders: " + std::to_string(stats.decoders) + ")");
+    QR_LOG_INFO("  Total detections: " + std::to_string(stats.total_detections));
+    QR_LOG_INFO("  Successful: " + std::to_string(stats.successful_detections));
+    QR_LOG_INFO("  Success rate: " + std::to_string(static_cast<int>(stats.getSuccessRate() * 100)) + "%");
+    QR_LOG_INFO("  Throughput: " + std::to_string(stats.getThroughput()) + " images/s");
+    QR_LOG_INFO("  Bytes read: " + std::to_string(stats.bytes_read) +
+                ", pooled decodes: " + std::to_string(stats.pooled_decodes) +
+                ", decode allocations: " + std::to_string(stats.decode_allocations));
+
+    if (config.decode.reduction > 1) {
+        QR_LOG_INFO("  Reduced decodes: " + std::to_string(stats.reduced_decodes) +
+                    ", full resolution retries: " + std::to_string(stats.full_resolution_retries));
+    }
+
+    if (config.quality_gate_enabled) {
+        logGateStats(stats.gate_stats);
+    }
+
+    if (config.debug_capture.enabled) {
+        logCaptureStats(stats.capture_stats);
+    }
+
+    if (config.save_results) {
+        QR_LOG_INFO("  Visualizations written: " + std::to_string(stats.render_stats.written) + " (" +
+                    std::to_string(stats.render_stats.bytes_written) + " bytes, " +
+                    std::to_string(stats.render_stats.render_ms) + " ms in background)");
+    }
+
+    if (!config.results.path.empty()) {
+        QR_LOG_INFO("  Results written: " + std::to_string(stats.writer_stats.records) + " records, " +
+                    std::to_string(stats.writer_stats.bytes_written) + " bytes, " +
+                    std::to_string(stats.writer_stats.flushes) + " flushes, " +
+                    std::to_string(stats.writer_stats.checkpoints) + " checkpoints");
+    }
+
+    if (config.cache_enabled) {
+        QR_LOG_INFO("  Cache memory/disk hits: " + std::to_string(stats.cache_stats.memory_hits) + " / " +
+                    std::to_string(stats.cache_stats.disk_hits) + ", misses: " +
+                    std::to_string(stats.cache_stats.misses) + ", hit rate: " +
+                    std::to_string(static_cast<int>(stats.cache_stats.getHitRate() * 100)) + "%");
+    }
+
+    QR_LOG_INFO("Preprocessing stages (attempts / wins / avg ms / wins per ms):");
+    for (const auto& stage : stats.stage_stats) {
+        std::stringstream line;
+        line << std::fixed << std::setprecision(3)
+             << "  " << stage.name << ": " << stage.attempts << " / " << stage.wins
+             << " / " << stage.getAverageMs() << " / " << stage.getWinsPerMs();
+        QR_LOG_INFO(line.str());
+    }
 
+    // Логи пишет фоновый поток — дожидаемся их перед прямым выводом в консоль
+    Logger::flush();
     std::cout << "\n=== Test Completed ===" << std::endl;
     return 0;
 }
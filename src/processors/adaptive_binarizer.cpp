@@ -0,0 +1,94 @@
+#include "adaptive_binarizer.h"
+#include "image_processor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Интегральные изображения строятся по полосам строк с перекрытием на радиус окна:
+// память на полосу (BAND_ROWS + 2 * radius) x cols вместо двух полнокадровых
+// CV_64F-матриц (около 320 МБ на 20-мегапиксельный кадр)
+const int BAND_ROWS = 128;
+
+} // namespace
+
+cv::Mat AdaptiveBinarizer::binarize(const cv::Mat& image, const Params& params) {
+    if (image.empty()) {
+        return image;
+    }
+
+    cv::Mat gray = ImageProcessor::convertToGrayscale(image);
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
+
+    const bool sauvola = params.method == SAUVOLA;
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    const int radius = resolveBlockSize(gray.size(), params.block_size) / 2;
+    const int bands = (rows + BAND_ROWS - 1) / BAND_ROWS;
+    cv::Mat binary(gray.size(), CV_8UC1);
+
+    auto process_bands = [&](const cv::Range& range) {
+        // Суммы в double: на больших сканах 32-битная сумма переполняется
+        cv::Mat sum;
+        cv::Mat sqsum;
+
+        for (int band = range.start; band < range.end; ++band) {
+            const int band_begin = band * BAND_ROWS;
+            const int band_end = std::min(band_begin + BAND_ROWS, rows);
+            const int top = std::max(band_begin - radius, 0);
+            const int bottom = std::min(band_end + radius + 1, rows);
+
+            // Строка r интеграла соответствует строке top + r кадра
+            if (sauvola) {
+                cv::integral(gray.rowRange(top, bottom), sum, sqsum, CV_64F, CV_64F);
+            } else {
+                cv::integral(gray.rowRange(top, bottom), sum, CV_64F);
+            }
+
+            for (int y = band_begin; y < band_end; ++y) {
+                int y0 = std::max(y - radius, 0);
+                int y1 = std::min(y + radius + 1, rows);
+                const double* sum_top = sum.ptr<double>(y0 - top);
+                const double* sum_bottom = sum.ptr<double>(y1 - top);
+                const double* sq_top = sauvola ? sqsum.ptr<double>(y0 - top) : nullptr;
+                const double* sq_bottom = sauvola ? sqsum.ptr<double>(y1 - top) : nullptr;
+                const uchar* src = gray.ptr<uchar>(y);
+                uchar* dst = binary.ptr<uchar>(y);
+
+                for (int x = 0; x < cols; ++x) {
+                    int x0 = std::max(x - radius, 0);
+                    int x1 = std::min(x + radius + 1, cols);
+                    double area = static_cast<double>((y1 - y0) * (x1 - x0));
+                    double mean = (sum_bottom[x1] - sum_top[x1] - sum_bottom[x0] + sum_top[x0]) / area;
+
+                    double threshold;
+                    if (sauvola) {
+                        double sq_mean = (sq_bottom[x1] - sq_top[x1] - sq_bottom[x0] + sq_top[x0]) / area;
+                        double stddev = std::sqrt(std::max(sq_mean - mean * mean, 0.0));
+                        threshold = mean * (1.0 + params.k * (stddev / params.dynamic_range - 1.0));
+                    } else {
+                        threshold = mean - params.offset;
+                    }
+
+                    dst[x] = src[x] > threshold ? 255 : 0;
+                }
+            }
+        }
+    };
+
+    // В пакетном режиме OpenCV работает в одном потоке — полосы идут последовательно,
+    // а параллелизм даёт пул детекции
+    cv::parallel_for_(cv::Range(0, bands), process_bands);
+
+    return binary;
+}
+
+int AdaptiveBinarizer::resolveBlockSize(const cv::Size& size, int block_size) {
+    if (block_size <= 0) {
+        // Окно должно накрывать несколько модулей кода, но не весь перепад освещения
+        block_size = std::max(15, std::min(size.width, size.height) / 16);
+    }
+    return block_size | 1;
+}
@@ -0,0 +1,32 @@
+#ifndef QR_READER_ADAPTIVE_BINARIZER_H
+#define QR_READER_ADAPTIVE_BINARIZER_H
+
+#include <opencv2/opencv.hpp>
+
+// Локальная бинаризация для неравномерного освещения (блики, тени).
+// Порог каждого пикселя считается по окну вокруг него через интегральные
+// изображения — O(1) на пиксель независимо от размера окна. Интегралы
+// строятся по полосам строк, так что память не растёт с высотой кадра.
+class AdaptiveBinarizer {
+public:
+    enum Method {
+        MEAN,       // порог = среднее окна - offset
+        SAUVOLA     // порог = m * (1 + k * (s / R - 1))
+    };
+
+    struct Params {
+        Method method = SAUVOLA;
+        int block_size = 0;         // сторона окна в пикселях, 0 = по размеру кадра
+        double offset = 7.0;        // для MEAN
+        double k = 0.2;             // для SAUVOLA
+        double dynamic_range = 128.0;   // R для SAUVOLA
+    };
+
+    // Одноканальный результат 0/255; полосы строк со своими интегралами
+    // обрабатываются через cv::parallel_for_
+    static cv::Mat binarize(const cv::Mat& image, const Params& params);
+
+    static int resolveBlockSize(const cv::Size& size, int block_size);
+};
+
+#endif // QR_READER_ADAPTIVE_BINARIZER_H
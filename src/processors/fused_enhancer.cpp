@@ -0,0 +1,352 @@
+#include "fused_enhancer.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+namespace {
+
+// Рабочий набор полосы: несколько строк входа и выхода плюс строки-соседи фильтра
+const int L2_BUDGET_BYTES = 256 * 1024;
+const int MIN_BAND_ROWS = 8;
+
+// Параметры CLAHE эталонной цепочки (ImageProcessor::applyCLAHE)
+const double CLAHE_CLIP_LIMIT = 2.0;
+const int CLAHE_TILES = 8;
+const int CLAHE_HIST_SIZE = 256;
+
+#if CV_SIMD
+// nlanes устарел и убран в масштабируемых сборках OpenCV 4.9+
+inline int u8Lanes() {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 8)
+    return cv::VTraits<cv::v_uint8>::vlanes();
+#else
+    return cv::v_uint8::nlanes;
+#endif
+}
+#endif
+
+// Вертикальный максимум/минимум трёх строк; отсутствующая строка (за краем) — nullptr
+template <bool IsMax>
+void verticalPass(const uchar* above, const uchar* center, const uchar* below, uchar* dst, int width) {
+    int x = 0;
+#if CV_SIMD
+    const int lanes = u8Lanes();
+    for (; x <= width - lanes; x += lanes) {
+        cv::v_uint8 value = cv::vx_load(center + x);
+        if (above) value = IsMax ? cv::v_max(value, cv::vx_load(above + x)) : cv::v_min(value, cv::vx_load(above + x));
+        if (below) value = IsMax ? cv::v_max(value, cv::vx_load(below + x)) : cv::v_min(value, cv::vx_load(below + x));
+        cv::v_store(dst + x, value);
+    }
+#endif
+    for (; x < width; ++x) {
+        uchar value = center[x];
+        if (above) value = IsMax ? std::max(value, above[x]) : std::min(value, above[x]);
+        if (below) value = IsMax ? std::max(value, below[x]) : std::min(value, below[x]);
+        dst[x] = value;
+    }
+}
+
+// Горизонтальный максимум/минимум по строке с отступом в один пиксель с каждой стороны
+template <bool IsMax>
+void horizontalPass(const uchar* padded, uchar* dst, int width) {
+    int x = 0;
+#if CV_SIMD
+    const int lanes = u8Lanes();
+    for (; x <= width - lanes; x += lanes) {
+        cv::v_uint8 left = cv::vx_load(padded + x);
+        cv::v_uint8 center = cv::vx_load(padded + x + 1);
+        cv::v_uint8 right = cv::vx_load(padded + x + 2);
+        cv::v_store(dst + x, IsMax ? cv::v_max(cv::v_max(left, center), right)
+                                   : cv::v_min(cv::v_min(left, center), right));
+    }
+#endif
+    for (; x < width; ++x) {
+        dst[x] = IsMax ? std::max(std::max(padded[x], padded[x + 1]), padded[x + 2])
+                       : std::min(std::min(padded[x], padded[x + 1]), padded[x + 2]);
+    }
+}
+
+} // namespace
+
+cv::Mat FusedEnhancer::enhance(const cv::Mat& image) {
+    if (image.empty()) {
+        return image;
+    }
+
+    // 1. Серый + гистограмма за один проход по полосам
+    cv::Mat gray;
+    int histogram[256] = {0};
+    grayAndHistogram(image, gray, histogram);
+
+    // 2. Порог Оцу по готовой гистограмме — без второго прохода по кадру
+    int thresh = otsuThreshold(histogram, gray.total());
+
+    // 3. Таблицы CLAHE по числу пикселей выше порога в каждом тайле
+    BinaryClahe clahe = buildBinaryClahe(gray, thresh);
+
+    // 4. Порог, CLAHE и закрытие 3x3 за один проход по строкам
+    cv::Mat processed(gray.size(), CV_8UC1);
+    thresholdClaheClose(gray, thresh, clahe, processed);
+
+    if (std::min(processed.rows, processed.cols) < 300) {
+        double scale = 600.0 / std::min(processed.rows, processed.cols);
+        cv::resize(processed, processed, cv::Size(), scale, scale, cv::INTER_CUBIC);
+    }
+
+    return processed;
+}
+
+int FusedEnhancer::computeBandRows(int row_bytes) {
+    return std::max(MIN_BAND_ROWS, L2_BUDGET_BYTES / std::max(row_bytes * 4, 1));
+}
+
+void FusedEnhancer::grayAndHistogram(const cv::Mat& image, cv::Mat& gray, int histogram[256]) {
+    if (image.channels() == 1) {
+        gray = image;
+    } else {
+        gray.create(image.size(), CV_8UC1);
+    }
+
+    // Четыре частичные гистограммы снимают зависимость по записи в один счётчик
+    std::vector<int> partial(4 * 256, 0);
+    int band_rows = computeBandRows(image.cols * static_cast<int>(image.elemSize()));
+
+    for (int y0 = 0; y0 < image.rows; y0 += band_rows) {
+        int y1 = std::min(y0 + band_rows, image.rows);
+
+        if (image.channels() != 1) {
+            cv::Mat band = gray.rowRange(y0, y1);
+            cv::cvtColor(image.rowRange(y0, y1), band,
+                         image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        }
+
+        // Полоса только что записана и ещё лежит в кэше
+        for (int y = y0; y < y1; ++y) {
+            const uchar* row = gray.ptr<uchar>(y);
+            int x = 0;
+            for (; x <= gray.cols - 4; x += 4) {
+                partial[row[x]]++;
+                partial[256 + row[x + 1]]++;
+                partial[512 + row[x + 2]]++;
+                partial[768 + row[x + 3]]++;
+            }
+            for (; x < gray.cols; ++x) {
+                partial[row[x]]++;
+            }
+        }
+    }
+
+    for (int i = 0; i < 256; ++i) {
+        histogram[i] = partial[i] + partial[256 + i] + partial[512 + i] + partial[768 + i];
+    }
+}
+
+int FusedEnhancer::otsuThreshold(const int histogram[256], size_t total) {
+    // Та же арифметика, что в cv::threshold(..., THRESH_OTSU) для 8U
+    const int N = 256;
+    double mu = 0, scale = 1. / static_cast<double>(total);
+    for (int i = 0; i < N; i++) {
+        mu += i * static_cast<double>(histogram[i]);
+    }
+    mu *= scale;
+
+    double mu1 = 0, q1 = 0;
+    double max_sigma = 0, max_val = 0;
+    for (int i = 0; i < N; i++) {
+        double p_i, q2, mu2, sigma;
+        p_i = histogram[i] * scale;
+        mu1 *= q1;
+        q1 += p_i;
+        q2 = 1. - q1;
+
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1. - FLT_EPSILON) {
+            continue;
+        }
+
+        mu1 = (mu1 + i * p_i) / q1;
+        mu2 = (mu - q1 * mu1) / q2;
+        sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > max_sigma) {
+            max_sigma = sigma;
+            max_val = i;
+        }
+    }
+
+    return static_cast<int>(max_val);
+}
+
+FusedEnhancer::BinaryClahe FusedEnhancer::buildBinaryClahe(const cv::Mat& gray, int thresh) {
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    const uchar t = static_cast<uchar>(std::min(std::max(thresh, 0), 255));
+
+    // Как в cv::CLAHE: если кадр не делится на тайлы хотя бы по одной оси, он дополняется
+    // отражением (BORDER_REFLECT_101) справа и снизу по обеим осям
+    int ext_rows = rows;
+    int ext_cols = cols;
+    if (rows % CLAHE_TILES != 0 || cols % CLAHE_TILES != 0) {
+        ext_rows = rows + CLAHE_TILES - rows % CLAHE_TILES;
+        ext_cols = cols + CLAHE_TILES - cols % CLAHE_TILES;
+    }
+
+    BinaryClahe clahe;
+    clahe.tile_width = ext_cols / CLAHE_TILES;
+    clahe.tile_height = ext_rows / CLAHE_TILES;
+
+    // Пиксели выше порога в каждой строке по столбцам тайлов, с отражёнными столбцами
+    std::vector<int> row_counts(static_cast<size_t>(rows) * CLAHE_TILES, 0);
+    for (int y = 0; y < rows; ++y) {
+        const uchar* in = gray.ptr<uchar>(y);
+        int* counts = &row_counts[static_cast<size_t>(y) * CLAHE_TILES];
+        for (int tx = 0; tx < CLAHE_TILES; ++tx) {
+            int x1 = std::min((tx + 1) * clahe.tile_width, cols);
+            int count = 0;
+            for (int x = tx * clahe.tile_width; x < x1; ++x) {
+                count += in[x] > t;
+            }
+            counts[tx] = count;
+        }
+        for (int x = cols; x < ext_cols; ++x) {
+            counts[x / clahe.tile_width] += in[cv::borderInterpolate(x, cols, cv::BORDER_REFLECT_101)] > t;
+        }
+    }
+
+    std::vector<int> tile_counts(CLAHE_TILES * CLAHE_TILES, 0);
+    for (int y = 0; y < ext_rows; ++y) {
+        int source = y < rows ? y : cv::borderInterpolate(y, rows, cv::BORDER_REFLECT_101);
+        int* tiles = &tile_counts[(y / clahe.tile_height) * CLAHE_TILES];
+        const int* counts = &row_counts[static_cast<size_t>(source) * CLAHE_TILES];
+        for (int tx = 0; tx < CLAHE_TILES; ++tx) {
+            tiles[tx] += counts[tx];
+        }
+    }
+
+    // Отсечение, перераспределение и накопление — та же арифметика, что в cv::CLAHE для 8U
+    const int tile_total = clahe.tile_width * clahe.tile_height;
+    const float lut_scale = static_cast<float>(CLAHE_HIST_SIZE - 1) / tile_total;
+    const int clip_limit = std::max(static_cast<int>(CLAHE_CLIP_LIMIT * tile_total / CLAHE_HIST_SIZE), 1);
+
+    clahe.lut_low.resize(tile_counts.size());
+    clahe.lut_high.resize(tile_counts.size());
+    int histogram[CLAHE_HIST_SIZE];
+    for (size_t tile = 0; tile < tile_counts.size(); ++tile) {
+        std::fill(histogram, histogram + CLAHE_HIST_SIZE, 0);
+        histogram[0] = tile_total - tile_counts[tile];
+        histogram[CLAHE_HIST_SIZE - 1] += tile_counts[tile];
+
+        int clipped = 0;
+        for (int i = 0; i < CLAHE_HIST_SIZE; ++i) {
+            if (histogram[i] > clip_limit) {
+                clipped += histogram[i] - clip_limit;
+                histogram[i] = clip_limit;
+            }
+        }
+        int redist_batch = clipped / CLAHE_HIST_SIZE;
+        int residual = clipped - redist_batch * CLAHE_HIST_SIZE;
+        for (int i = 0; i < CLAHE_HIST_SIZE; ++i) {
+            histogram[i] += redist_batch;
+        }
+        if (residual != 0) {
+            int residual_step = std::max(CLAHE_HIST_SIZE / residual, 1);
+            for (int i = 0; i < CLAHE_HIST_SIZE && residual > 0; i += residual_step, residual--) {
+                histogram[i]++;
+            }
+        }
+
+        // Нужны только два значения накопленной таблицы: после бина 0 и после бина 255
+        int sum = 0;
+        for (int i = 0; i < CLAHE_HIST_SIZE; ++i) {
+            sum += histogram[i];
+        }
+        clahe.lut_low[tile] = cv::saturate_cast<uchar>(histogram[0] * lut_scale);
+        clahe.lut_high[tile] = cv::saturate_cast<uchar>(sum * lut_scale);
+    }
+
+    return clahe;
+}
+
+void FusedEnhancer::thresholdClaheClose(const cv::Mat& gray, int thresh, const BinaryClahe& clahe, cv::Mat& dst) {
+    const int width = gray.cols;
+    const int height = gray.rows;
+    const uchar t = static_cast<uchar>(std::min(std::max(thresh, 0), 255));
+
+    // Веса интерполяции между тайлами — те же выражения во float, что в cv::CLAHE,
+    // иначе округление разошлось бы с эталоном
+    std::vector<int> tx1(width);
+    std::vector<int> tx2(width);
+    std::vector<float> xa(width);
+    std::vector<float> xa1(width);
+    const float inv_tw = 1.0f / clahe.tile_width;
+    for (int x = 0; x < width; ++x) {
+        float txf = x * inv_tw - 0.5f;
+        int left = cvFloor(txf);
+        xa[x] = txf - left;
+        xa1[x] = 1.0f - xa[x];
+        tx1[x] = std::max(left, 0);
+        tx2[x] = std::min(left + 1, CLAHE_TILES - 1);
+    }
+    const float inv_th = 1.0f / clahe.tile_height;
+
+    // Кольца по три строки: контрастный кадр и его расширение. На шаге i готовится
+    // контрастная строка i, расширенная строка i-1 и выходная строка i-2
+    cv::Mat contrasted(3, width, CV_8UC1);
+    cv::Mat dilated(3, width, CV_8UC1);
+    std::vector<uchar> padded(width + 2);
+
+    for (int i = 0; i < height + 2; ++i) {
+        if (i < height) {
+            float tyf = i * inv_th - 0.5f;
+            int ty1 = cvFloor(tyf);
+            int ty2 = ty1 + 1;
+            float ya = tyf - ty1, ya1 = 1.0f - ya;
+            ty1 = std::max(ty1, 0);
+            ty2 = std::min(ty2, CLAHE_TILES - 1);
+
+            const uchar* low1 = &clahe.lut_low[ty1 * CLAHE_TILES];
+            const uchar* high1 = &clahe.lut_high[ty1 * CLAHE_TILES];
+            const uchar* low2 = &clahe.lut_low[ty2 * CLAHE_TILES];
+            const uchar* high2 = &clahe.lut_high[ty2 * CLAHE_TILES];
+
+            const uchar* in = gray.ptr<uchar>(i);
+            uchar* out = contrasted.ptr<uchar>(i % 3);
+            for (int x = 0; x < width; ++x) {
+                // Порог на лету: бинарный пиксель выбирает одну из двух таблиц
+                bool high = in[x] > t;
+                const uchar* lut1 = high ? high1 : low1;
+                const uchar* lut2 = high ? high2 : low2;
+                float res = (lut1[tx1[x]] * xa1[x] + lut1[tx2[x]] * xa[x]) * ya1 +
+                            (lut2[tx1[x]] * xa1[x] + lut2[tx2[x]] * xa[x]) * ya;
+                out[x] = cv::saturate_cast<uchar>(res);
+            }
+        }
+
+        // Расширение: за краем кадра значение 0, на максимум не влияет
+        int d = i - 1;
+        if (d >= 0 && d < height) {
+            padded[0] = 0;
+            padded[width + 1] = 0;
+            verticalPass<true>(d > 0 ? contrasted.ptr<uchar>((d - 1) % 3) : nullptr,
+                               contrasted.ptr<uchar>(d % 3),
+                               d + 1 < height ? contrasted.ptr<uchar>((d + 1) % 3) : nullptr,
+                               padded.data() + 1, width);
+            horizontalPass<true>(padded.data(), dilated.ptr<uchar>(d % 3), width);
+        }
+
+        // Сужение: за краем кадра значение 255, на минимум не влияет
+        int e = i - 2;
+        if (e >= 0) {
+            padded[0] = 255;
+            padded[width + 1] = 255;
+            verticalPass<false>(e > 0 ? dilated.ptr<uchar>((e - 1) % 3) : nullptr,
+                                dilated.ptr<uchar>(e % 3),
+                                e + 1 < height ? dilated.ptr<uchar>((e + 1) % 3) : nullptr,
+                                padded.data() + 1, width);
+            horizontalPass<false>(padded.data(), dst.ptr<uchar>(e), width);
+        }
+    }
+
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
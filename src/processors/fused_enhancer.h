@@ -0,0 +1,35 @@
+#ifndef QR_READER_FUSED_ENHANCER_H
+#define QR_READER_FUSED_ENHANCER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Слитная реализация цепочки ImageProcessor::enhanceForQRDetection:
+// серый, порог Оцу, CLAHE 8x8 и морфологическое закрытие 3x3.
+// Порогу и гистограммам тайлов CLAHE нужна статистика всего кадра, поэтому кадр
+// проходится трижды: серый + гистограмма полосами, помещающимися в L2; подсчёт
+// пикселей выше порога по тайлам (только чтение); и один потоковый проход, где порог,
+// интерполяция CLAHE и закрытие применяются к скользящему окну из трёх строк.
+// Бинарный, контрастный и расширенный кадры целиком не создаются.
+// Результат побитно совпадает с эталонной цепочкой.
+class FusedEnhancer {
+public:
+    static cv::Mat enhance(const cv::Mat& image);
+
+private:
+    // После порога в кадре два уровня, и таблица CLAHE каждого тайла сводится к двум значениям
+    struct BinaryClahe {
+        int tile_width = 0;
+        int tile_height = 0;
+        std::vector<uchar> lut_low;     // тайлы построчно; выход для пикселя 0
+        std::vector<uchar> lut_high;    // выход для пикселя 255
+    };
+
+    static int computeBandRows(int row_bytes);
+    static void grayAndHistogram(const cv::Mat& image, cv::Mat& gray, int histogram[256]);
+    static int otsuThreshold(const int histogram[256], size_t total);
+    static BinaryClahe buildBinaryClahe(const cv::Mat& gray, int thresh);
+    static void thresholdClaheClose(const cv::Mat& gray, int thresh, const BinaryClahe& clahe, cv::Mat& dst);
+};
+
+#endif // QR_READER_FUSED_ENHANCER_H
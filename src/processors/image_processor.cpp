@@ -1,21 +1,68 @@
 #include "image_processor.h"
+#include "adaptive_binarizer.h"
+#include "fused_enhancer.h"
 #include "../utils/logger.h"
+#include "../utils/profiler.h"
+
+std::atomic<bool> ImageProcessor::fused_enhancement_{false};
+std::atomic<int> ImageProcessor::binarization_method_{BINARIZE_OTSU};
+
+void ImageProcessor::setFusedEnhancement(bool enabled) {
+    fused_enhancement_ = enabled;
+}
+
+bool ImageProcessor::isFusedEnhancementEnabled() {
+    return fused_enhancement_;
+}
+
+void ImageProcessor::setBinarizationMethod(BinarizationMethod method) {
+    binarization_method_ = method;
+}
+
+ImageProcessor::BinarizationMethod ImageProcessor::getBinarizationMethod() {
+    return static_cast<BinarizationMethod>(binarization_method_.load());
+}
+
+bool ImageProcessor::parseBinarizationMethod(const std::string& name, BinarizationMethod& method) {
+    if (name == "otsu") {
+        method = BINARIZE_OTSU;
+    } else if (name == "mean") {
+        method = BINARIZE_MEAN;
+    } else if (name == "sauvola") {
+        method = BINARIZE_SAUVOLA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+cv::Mat ImageProcessor::binarize(const cv::Mat& image, BinarizationMethod method) {
+    if (method == BINARIZE_OTSU) {
+        cv::Mat binary;
+        cv::threshold(convertToGrayscale(image), binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        return binary;
+    }
+
+    AdaptiveBinarizer::Params params;
+    params.method = method == BINARIZE_MEAN ? AdaptiveBinarizer::MEAN : AdaptiveBinarizer::SAUVOLA;
+    return AdaptiveBinarizer::binarize(image, params);
+}
 
 cv::Mat ImageProcessor::enhanceForQRDetection(const cv::Mat& image) {
-    Logger::startOperation("Enhancing image for QR detection");
+    ScopedTimer timer("ImageProcessor::enhanceForQRDetection");
 
     if (image.empty()) {
         return image;
     }
 
-    cv::Mat processed = image.clone();
+    BinarizationMethod method = getBinarizationMethod();
 
-    if (processed.channels() > 1) {
-        cv::cvtColor(processed, processed, cv::COLOR_BGR2GRAY);
+    if (fused_enhancement_ && method == BINARIZE_OTSU) {
+        return FusedEnhancer::enhance(image);
     }
 
-    cv::Mat binary;
-    cv::threshold(processed, processed, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    // Бинаризация сама пишет в новый буфер — предварительный clone() не нужен
+    cv::Mat processed = binarize(image, method);
 
     processed = enhanceContrast(processed);
 
@@ -27,13 +74,17 @@ cv::Mat ImageProcessor::enhanceForQRDetection(const cv::Mat& image) {
         cv::resize(processed, processed, cv::Size(), scale, scale, cv::INTER_CUBIC);
     }
 
-    Logger::endOperation("Enhancing image for QR detection");
     return processed;
 }
 
 cv::Mat ImageProcessor::convertToGrayscale(const cv::Mat& image) {
+    // Одноканальный кадр уже готов — отдаём тот же буфер без прохода по памяти
+    if (image.channels() == 1) {
+        return image;
+    }
+
     cv::Mat gray;
-    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
     return gray;
 }
 
@@ -87,9 +138,9 @@ cv::Mat ImageProcessor::resizeImage(const cv::Mat& image, int min_size) {
     cv::Mat resized;
     cv::resize(image, resized, cv::Size(new_width, new_height), 0, 0, cv::INTER_CUBIC);
 
-    Logger::debug("Image resized from " + std::to_string(image.cols) + "x" +
-                  std::to_string(image.rows) + " to " + std::to_string(new_width) +
-                  "x" + std::to_string(new_height));
+    QR_LOG_DEBUG("Image resized from " + std::to_string(image.cols) + "x" +
+                 std::to_string(image.rows) + " to " + std::to_string(new_width) +
+                 "x" + std::to_string(new_height));
 
     return resized;
 }
@@ -100,11 +151,21 @@ cv::Mat ImageProcessor::adjustBrightness(const cv::Mat& image, double alpha, int
     return adjusted;
 }
 
+double ImageProcessor::calculateMeanLuma(const cv::Mat& image) {
+    if (image.empty()) return 0.0;
+
+    cv::Scalar mean = cv::mean(image);
+    if (image.channels() < 3) {
+        return mean[0];
+    }
+    // Порядок каналов BGR(A): взвешиваем средние тем же образом, что и cvtColor
+    return 0.114 * mean[0] + 0.587 * mean[1] + 0.299 * mean[2];
+}
+
 bool ImageProcessor::needsEnhancement(const cv::Mat& image) {
     if (image.empty()) return false;
 
-    cv::Scalar mean = cv::mean(image);
-    double avg_brightness = mean[0];
+    double avg_brightness = calculateMeanLuma(image);
 
     return avg_brightness < 50 || avg_brightness > 200;
 }
@@ -112,12 +173,8 @@ bool ImageProcessor::needsEnhancement(const cv::Mat& image) {
 double ImageProcessor::calculateQualityScore(const cv::Mat& image) {
     if (image.empty()) return 0.0;
 
-    cv::Mat gray, laplacian;
-    if (image.channels() > 1) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image;
-    }
+    cv::Mat gray = convertToGrayscale(image);
+    cv::Mat laplacian;
 
     cv::Laplacian(gray, laplacian, CV_64F);
     cv::Scalar mean, stddev;
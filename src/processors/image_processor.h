@@ -1,11 +1,30 @@
 #ifndef QR_READER_IMAGE_PROCESSOR_H
 #define QR_READER_IMAGE_PROCESSOR_H
 
+#include <atomic>
 #include <opencv2/opencv.hpp>
+#include <string>
 
 class ImageProcessor {
 public:
+    // Бинаризация внутри enhanceForQRDetection
+    enum BinarizationMethod {
+        BINARIZE_OTSU,      // один глобальный порог
+        BINARIZE_MEAN,      // локальное среднее окна
+        BINARIZE_SAUVOLA    // локальные среднее и дисперсия окна
+    };
+
     static cv::Mat enhanceForQRDetection(const cv::Mat& image);
+    // Слитное ядро FusedEnhancer вместо цепочки отдельных вызовов OpenCV;
+    // результат побитно тот же (проверяется бенчмарком qr_bench fused)
+    static void setFusedEnhancement(bool enabled);
+    static bool isFusedEnhancementEnabled();
+    // Слитное ядро реализует только Оцу; локальные методы идут обычной цепочкой
+    static void setBinarizationMethod(BinarizationMethod method);
+    static BinarizationMethod getBinarizationMethod();
+    static bool parseBinarizationMethod(const std::string& name, BinarizationMethod& method);
+
+    static cv::Mat binarize(const cv::Mat& image, BinarizationMethod method);
 
     static cv::Mat convertToGrayscale(const cv::Mat& image);
     static cv::Mat enhanceContrast(const cv::Mat& image);
@@ -14,10 +33,15 @@ public:
     static cv::Mat resizeImage(const cv::Mat& image, int min_size = 500);
     static cv::Mat adjustBrightness(const cv::Mat& image, double alpha = 1.0, int beta = 0);
 
+    // Средняя яркость (luma BT.601) без построения серого кадра
+    static double calculateMeanLuma(const cv::Mat& image);
     static bool needsEnhancement(const cv::Mat& image);
     static double calculateQualityScore(const cv::Mat& image);
 
 private:
+    static std::atomic<bool> fused_enhancement_;
+    static std::atomic<int> binarization_method_;
+
     static cv::Mat applyCLAHE(const cv::Mat& image);
     static cv::Mat applyBilateralFilter(const cv::Mat& image);
 };
@@ -0,0 +1,118 @@
+#include "module_sampler.h"
+#include "image_processor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Размеры QR версий 1..40: 21, 25, ..., 177 модулей
+const int MIN_MODULES = 21;
+const int MAX_MODULES = 177;
+
+bool isValidModuleCount(int modules) {
+    return modules >= MIN_MODULES && modules <= MAX_MODULES && (modules - MIN_MODULES) % 4 == 0;
+}
+
+} // namespace
+
+ModuleSampler::ModuleScore ModuleSampler::measure(const cv::Mat& image, const std::vector<cv::Point>& quad,
+                                                  const cv::Mat& straight_qrcode) {
+    ModuleScore score;
+    if (image.empty() || quad.size() != 4) {
+        return score;
+    }
+
+    int modules = resolveModuleCount(straight_qrcode);
+    if (modules == 0) {
+        return score;
+    }
+
+    // Выпрямляем только область кода: warpPerspective читает лишь нужные пиксели
+    const int side = modules * PIXELS_PER_MODULE;
+    cv::Point2f src[4];
+    for (int i = 0; i < 4; ++i) {
+        src[i] = cv::Point2f(static_cast<float>(quad[i].x), static_cast<float>(quad[i].y));
+    }
+    cv::Point2f dst[4] = {
+        {0.0f, 0.0f},
+        {static_cast<float>(side), 0.0f},
+        {static_cast<float>(side), static_cast<float>(side)},
+        {0.0f, static_cast<float>(side)}
+    };
+
+    cv::Mat warped;
+    cv::warpPerspective(image, warped, cv::getPerspectiveTransform(src, dst), cv::Size(side, side),
+                        cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    warped = ImageProcessor::convertToGrayscale(warped);
+
+    std::vector<int> values = sampleModules(warped, modules);
+
+    // Классы модулей берутся из карты детектора; для нестандартного типа — порог по среднему
+    bool use_map = straight_qrcode.type() == CV_8UC1;
+    double midpoint = 0.0;
+    for (int v : values) midpoint += v;
+    midpoint /= values.size();
+
+    double sum[2] = {0.0, 0.0};
+    double sum_sq[2] = {0.0, 0.0};
+    int count[2] = {0, 0};
+    for (int r = 0; r < modules; ++r) {
+        for (int c = 0; c < modules; ++c) {
+            int v = values[r * modules + c];
+            int light = use_map ? (straight_qrcode.at<uchar>(r, c) > 127 ? 1 : 0) : (v > midpoint ? 1 : 0);
+            sum[light] += v;
+            sum_sq[light] += static_cast<double>(v) * v;
+            count[light]++;
+        }
+    }
+
+    if (count[0] == 0 || count[1] == 0) {
+        return score;
+    }
+
+    double mean_dark = sum[0] / count[0];
+    double mean_light = sum[1] / count[1];
+    double std_dark = std::sqrt(std::max(sum_sq[0] / count[0] - mean_dark * mean_dark, 0.0));
+    double std_light = std::sqrt(std::max(sum_sq[1] / count[1] - mean_light * mean_light, 0.0));
+    double threshold = (mean_dark + mean_light) / 2.0;
+
+    score.modules = modules;
+    score.contrast = std::max(mean_light - mean_dark, 0.0) / 255.0;
+    score.separation = std::max(mean_light - mean_dark, 0.0) / (std_dark + std_light + 1.0);
+
+    // Тайминговые линии: строка и столбец 6 между поисковыми узорами, тёмный на чётных позициях
+    int matches = 0;
+    int total = 0;
+    for (int i = 8; i < modules - 8; ++i) {
+        bool expect_dark = i % 2 == 0;
+        matches += (values[6 * modules + i] < threshold) == expect_dark;
+        matches += (values[i * modules + 6] < threshold) == expect_dark;
+        total += 2;
+    }
+    score.timing_regularity = total > 0 ? static_cast<double>(matches) / total : 0.0;
+    score.valid = true;
+
+    return score;
+}
+
+int ModuleSampler::resolveModuleCount(const cv::Mat& straight_qrcode) {
+    if (straight_qrcode.rows != straight_qrcode.cols || !isValidModuleCount(straight_qrcode.cols)) {
+        return 0;
+    }
+    return straight_qrcode.cols;
+}
+
+std::vector<int> ModuleSampler::sampleModules(const cv::Mat& warped, int modules) {
+    // Среднее центральных 2x2 пикселей модуля — края модуля размыты интерполяцией
+    std::vector<int> values(modules * modules);
+    const int offset = PIXELS_PER_MODULE / 2 - 1;
+    for (int r = 0; r < modules; ++r) {
+        const uchar* top = warped.ptr<uchar>(r * PIXELS_PER_MODULE + offset);
+        const uchar* bottom = warped.ptr<uchar>(r * PIXELS_PER_MODULE + offset + 1);
+        for (int c = 0; c < modules; ++c) {
+            int x = c * PIXELS_PER_MODULE + offset;
+            values[r * modules + c] = (top[x] + top[x + 1] + bottom[x] + bottom[x + 1] + 2) >> 2;
+        }
+    }
+    return values;
+}
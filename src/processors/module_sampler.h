@@ -0,0 +1,33 @@
+#ifndef QR_READER_MODULE_SAMPLER_H
+#define QR_READER_MODULE_SAMPLER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Оценка качества уже найденного кода: четырёхугольник выпрямляется в малую
+// каноническую сетку (несколько пикселей на модуль), после чего меряются
+// контраст модулей и регулярность тайминговых линий. Работа идёт только
+// по области кода, а не по всему кадру.
+class ModuleSampler {
+public:
+    struct ModuleScore {
+        bool valid = false;
+        int modules = 0;                // сторона кода в модулях
+        double contrast = 0.0;          // разница средних светлых и тёмных модулей, 0..1
+        double separation = 0.0;        // та же разница относительно разброса внутри классов
+        double timing_regularity = 0.0; // доля модулей тайминговых линий с ожидаемым цветом, 0..1
+    };
+
+    // straight_qrcode — бинарная карта модулей из cv::QRCodeDetector, по ней определяется
+    // сторона кода; без неё результат невалиден
+    static ModuleScore measure(const cv::Mat& image, const std::vector<cv::Point>& quad,
+                               const cv::Mat& straight_qrcode);
+
+private:
+    static const int PIXELS_PER_MODULE = 4;
+
+    static int resolveModuleCount(const cv::Mat& straight_qrcode);
+    static std::vector<int> sampleModules(const cv::Mat& warped, int modules);
+};
+
+#endif // QR_READER_MODULE_SAMPLER_H
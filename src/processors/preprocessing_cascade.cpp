@@ -0,0 +1,219 @@
+#include "preprocessing_cascade.h"
+#include "image_processor.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Меньше попыток — оценка стадии ещё случайна, вместо неё берётся средняя по каскаду
+const int MIN_ATTEMPTS_FOR_SCORE = 20;
+
+} // namespace
+
+double PreprocessingCascade::StageStats::getWinRate() const {
+    if (attempts == 0) return 0.0;
+    return static_cast<double>(wins) / attempts;
+}
+
+double PreprocessingCascade::StageStats::getAverageMs() const {
+    if (attempts == 0) return 0.0;
+    return total_ms / attempts;
+}
+
+double PreprocessingCascade::StageStats::getWinsPerMs() const {
+    if (total_ms <= 0.0) return 0.0;
+    return wins / total_ms;
+}
+
+PreprocessingCascade PreprocessingCascade::createDefault() {
+    PreprocessingCascade cascade;
+
+    // Порядок — по объёму работы на пиксель: сдвиг яркости, затем одноканальные
+    // Оцу+CLAHE, размытие для резкости, локальный порог и в конце билатеральный
+    // фильтр по всем каналам, который дороже всех остальных стадий вместе
+    cascade.addStage("raw", [](const cv::Mat& image) { return image; }, false);
+
+    cascade.addStage("brightness", [](const cv::Mat& image) {
+        if (!ImageProcessor::needsEnhancement(image)) {
+            return cv::Mat();
+        }
+        double avg_brightness = ImageProcessor::calculateMeanLuma(image);
+        return ImageProcessor::adjustBrightness(image, 1.0, static_cast<int>(128 - avg_brightness));
+    });
+
+    cascade.addStage("enhance", [](const cv::Mat& image) {
+        return ImageProcessor::enhanceForQRDetection(image);
+    });
+
+    cascade.addStage("sharpen", [](const cv::Mat& image) {
+        return ImageProcessor::sharpenImage(image);
+    });
+
+    // Локальный порог вытягивает коды с бликами и тенями за одну попытку
+    cascade.addStage("adaptive", [](const cv::Mat& image) {
+        return ImageProcessor::binarize(image, ImageProcessor::BINARIZE_SAUVOLA);
+    });
+
+    cascade.addStage("denoise", [](const cv::Mat& image) {
+        return ImageProcessor::removeNoise(image);
+    });
+
+    return cascade;
+}
+
+void PreprocessingCascade::addStage(const std::string& name, Strategy strategy, bool is_preprocessing) {
+    stages_.push_back({name, std::move(strategy), is_preprocessing});
+    StageStats stats;
+    stats.name = name;
+    stats_.push_back(stats);
+}
+
+void PreprocessingCascade::setOrder(const std::vector<std::string>& names) {
+    std::vector<Stage> stages;
+    std::vector<StageStats> stats;
+
+    for (const auto& name : names) {
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            if (stages_[i].name == name) {
+                stages.push_back(stages_[i]);
+                stats.push_back(stats_[i]);
+                break;
+            }
+        }
+        if (stages.empty() || stages.back().name != name) {
+            QR_LOG_WARNING("Unknown preprocessing stage: " + name);
+        }
+    }
+
+    // Попытка на исходном кадре остаётся всегда: без неё каскад с одними
+    // неизвестными именами не декодировал бы вообще ничего
+    bool has_raw = std::any_of(stages.begin(), stages.end(),
+                               [](const Stage& stage) { return !stage.is_preprocessing; });
+    if (!has_raw) {
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            if (!stages_[i].is_preprocessing) {
+                QR_LOG_WARNING("Stage '" + stages_[i].name + "' is always kept and runs first");
+                stages.insert(stages.begin(), stages_[i]);
+                stats.insert(stats.begin(), stats_[i]);
+                break;
+            }
+        }
+    }
+
+    stages_ = std::move(stages);
+    stats_ = std::move(stats);
+}
+
+void PreprocessingCascade::reorderByEfficiency() {
+    std::vector<size_t> order(stages_.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+    auto pinned_end = std::stable_partition(order.begin(), order.end(),
+                                            [this](size_t i) { return !stages_[i].is_preprocessing; });
+
+    // Априорная оценка — победы на миллисекунду по всем стадиям, у которых статистика уже есть
+    int prior_wins = 0;
+    double prior_ms = 0.0;
+    for (size_t i = 0; i < stats_.size(); ++i) {
+        if (stats_[i].attempts >= MIN_ATTEMPTS_FOR_SCORE) {
+            prior_wins += stats_[i].wins;
+            prior_ms += stats_[i].total_ms;
+        }
+    }
+    double prior = prior_ms > 0.0 ? prior_wins / prior_ms : 0.0;
+
+    std::vector<double> scores(stages_.size());
+    for (size_t i = 0; i < stats_.size(); ++i) {
+        scores[i] = stats_[i].attempts >= MIN_ATTEMPTS_FOR_SCORE ? stats_[i].getWinsPerMs() : prior;
+    }
+
+    std::stable_sort(pinned_end, order.end(), [&scores](size_t a, size_t b) {
+        return scores[a] > scores[b];
+    });
+
+    std::vector<Stage> stages;
+    std::vector<StageStats> stats;
+    for (size_t index : order) {
+        stages.push_back(stages_[index]);
+        stats.push_back(stats_[index]);
+    }
+
+    stages_ = std::move(stages);
+    stats_ = std::move(stats);
+}
+
+int PreprocessingCascade::run(const cv::Mat& image, const DecodeAttempt& try_decode,
+                              bool preprocessing_enabled, cv::Mat* winning_image, double* prepare_ms) {
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        if (!preprocessing_enabled && stages_[i].is_preprocessing) continue;
+
+        auto start = std::chrono::steady_clock::now();
+
+        // Стадия, упавшая на неподходящем входе (например, bilateralFilter на BGRA),
+        // считается неудачной попыткой, а каскад продолжается
+        cv::Mat prepared;
+        bool decoded = false;
+        try {
+            prepared = stages_[i].strategy(image);
+            if (prepare_ms) {
+                *prepare_ms += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            if (prepared.empty()) continue;
+
+            decoded = try_decode(prepared);
+        }
+        catch (const cv::Exception& e) {
+            QR_LOG_WARNING("Preprocessing stage '" + stages_[i].name + "' failed: " + std::string(e.what()));
+            prepared.release();
+        }
+
+        stats_[i].attempts++;
+        stats_[i].total_ms += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (decoded) {
+            stats_[i].wins++;
+            if (winning_image) {
+                *winning_image = prepared;
+            }
+            return static_cast<int>(i);
+        }
+
+        QR_LOG_DEBUG("Preprocessing stage '" + stages_[i].name + "' did not help");
+    }
+
+    return -1;
+}
+
+size_t PreprocessingCascade::size() const {
+    return stages_.size();
+}
+
+const std::string& PreprocessingCascade::getStageName(size_t index) const {
+    return stages_.at(index).name;
+}
+
+const std::vector<PreprocessingCascade::StageStats>& PreprocessingCascade::getStats() const {
+    return stats_;
+}
+
+void PreprocessingCascade::mergeStats(const std::vector<StageStats>& other) {
+    for (const auto& incoming : other) {
+        auto it = std::find_if(stats_.begin(), stats_.end(),
+                               [&](const StageStats& s) { return s.name == incoming.name; });
+        if (it == stats_.end()) continue;
+        it->attempts += incoming.attempts;
+        it->wins += incoming.wins;
+        it->total_ms += incoming.total_ms;
+    }
+}
+
+void PreprocessingCascade::resetStats() {
+    for (auto& stats : stats_) {
+        stats.attempts = 0;
+        stats.wins = 0;
+        stats.total_ms = 0.0;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef QR_READER_PREPROCESSING_CASCADE_H
+#define QR_READER_PREPROCESSING_CASCADE_H
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Цепочка стратегий предобработки от дешёвых к дорогим.
+// Запуск останавливается на первой стадии, после которой код распознан;
+// для каждой стадии копится статистика попыток, побед и затраченного времени.
+class PreprocessingCascade {
+public:
+    // Возвращает подготовленное изображение или пустой Mat, если стадия неприменима
+    using Strategy = std::function<cv::Mat(const cv::Mat&)>;
+    using DecodeAttempt = std::function<bool(const cv::Mat&)>;
+
+    struct Stage {
+        std::string name;
+        Strategy strategy;
+        bool is_preprocessing = true;   // false только для попытки на исходном кадре
+    };
+
+    struct StageStats {
+        std::string name;
+        int attempts = 0;
+        int wins = 0;
+        double total_ms = 0.0;
+
+        double getWinRate() const;
+        double getAverageMs() const;
+        double getWinsPerMs() const;
+    };
+
+    static PreprocessingCascade createDefault();
+
+    void addStage(const std::string& name, Strategy strategy, bool is_preprocessing = true);
+
+    // Оставляет только перечисленные стадии в заданном порядке; неизвестные имена пропускаются.
+    // Стадия на исходном кадре сохраняется всегда — если её нет в списке, она идёт первой
+    void setOrder(const std::vector<std::string>& names);
+    // Стадии на исходном кадре остаются первыми — они бесплатны; остальные сортируются по числу
+    // побед на миллисекунду. Стадии, ещё не набравшие статистики, получают среднюю оценку, а не ноль
+    void reorderByEfficiency();
+
+    // Индекс победившей стадии или -1; winning_image получает кадр, на котором код найден,
+    // prepare_ms — суммарное время самих стратегий без попыток декодирования
+    int run(const cv::Mat& image, const DecodeAttempt& try_decode,
+            bool preprocessing_enabled = true, cv::Mat* winning_image = nullptr,
+            double* prepare_ms = nullptr);
+
+    size_t size() const;
+    const std::string& getStageName(size_t index) const;
+    const std::vector<StageStats>& getStats() const;
+    void mergeStats(const std::vector<StageStats>& other);
+    void resetStats();
+
+private:
+    std::vector<Stage> stages_;
+    std::vector<StageStats> stats_;
+};
+
+#endif // QR_READER_PREPROCESSING_CASCADE_H
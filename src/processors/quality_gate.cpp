@@ -0,0 +1,152 @@
+#include "quality_gate.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Яркость пикселя в целых: (B + 2G + R) / 4 для цветного, значение для серого
+inline int lumaAt(const uchar* row, int x, int channels) {
+    if (channels == 1) return row[x];
+    const uchar* p = row + x * channels;
+    return (p[0] + 2 * p[1] + p[2]) >> 2;
+}
+
+} // namespace
+
+double QualityGate::GateStats::getRejectRate() const {
+    if (frames_checked == 0) return 0.0;
+    return static_cast<double>(frames_rejected) / frames_checked;
+}
+
+double QualityGate::GateStats::getEstimatedSavedMs() const {
+    if (failed_decodes == 0) return -gate_ms;
+    return frames_rejected * (failed_decode_ms / failed_decodes) - gate_ms;
+}
+
+void QualityGate::GateStats::merge(const GateStats& other) {
+    frames_checked += other.frames_checked;
+    frames_rejected += other.frames_rejected;
+    rejected_exposure += other.rejected_exposure;
+    rejected_blank += other.rejected_blank;
+    rejected_blurry += other.rejected_blurry;
+    gate_ms += other.gate_ms;
+    failed_decodes += other.failed_decodes;
+    failed_decode_ms += other.failed_decode_ms;
+}
+
+QualityGate::QualityGate() : QualityGate(Config()) {
+}
+
+QualityGate::QualityGate(const Config& config) : config_(config) {
+}
+
+QualityGate::Verdict QualityGate::evaluate(const cv::Mat& image) {
+    auto start = std::chrono::steady_clock::now();
+    Verdict verdict = measure(image);
+    stats_.gate_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    stats_.frames_checked++;
+    if (!verdict.passed) {
+        stats_.frames_rejected++;
+        switch (verdict.reason) {
+            case REJECTED_EXPOSURE: stats_.rejected_exposure++; break;
+            case REJECTED_BLANK: stats_.rejected_blank++; break;
+            case REJECTED_BLURRY: stats_.rejected_blurry++; break;
+            default: break;
+        }
+    }
+    return verdict;
+}
+
+void QualityGate::recordDecode(double ms, bool success) {
+    if (!success) {
+        stats_.failed_decodes++;
+        stats_.failed_decode_ms += ms;
+    }
+}
+
+const QualityGate::Config& QualityGate::getConfig() const {
+    return config_;
+}
+
+const QualityGate::GateStats& QualityGate::getStats() const {
+    return stats_;
+}
+
+void QualityGate::resetStats() {
+    stats_ = GateStats();
+}
+
+std::string QualityGate::getReasonName(Reason reason) {
+    switch (reason) {
+        case PASSED: return "passed";
+        case REJECTED_EXPOSURE: return "exposure";
+        case REJECTED_BLANK: return "blank";
+        case REJECTED_BLURRY: return "blurry";
+    }
+    return "unknown";
+}
+
+QualityGate::Verdict QualityGate::measure(const cv::Mat& image) const {
+    Verdict verdict;
+
+    // Нестандартные форматы и крошечные кадры не отсеиваем — пусть решает детектор
+    if (image.depth() != CV_8U || image.rows < 3 || image.cols < 3) {
+        return verdict;
+    }
+
+    const int channels = image.channels();
+    const int64_t area = static_cast<int64_t>(image.rows) * image.cols;
+    const int step = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(area) /
+                                                            std::max(config_.target_samples, 1))));
+
+    int64_t count = 0;
+    int64_t sum = 0;
+    int64_t sum_sq = 0;
+    int64_t edges = 0;
+
+    // Лапласиан берётся по соседям в полном разрешении — резкость не теряется
+    // от прореживания, а сетка лишь выбирает, где его считать
+    for (int y = 1; y < image.rows - 1; y += step) {
+        const uchar* above = image.ptr<uchar>(y - 1);
+        const uchar* row = image.ptr<uchar>(y);
+        const uchar* below = image.ptr<uchar>(y + 1);
+
+        for (int x = 1; x < image.cols - 1; x += step) {
+            int center = lumaAt(row, x, channels);
+            int laplacian = 4 * center - lumaAt(row, x - 1, channels) - lumaAt(row, x + 1, channels) -
+                            lumaAt(above, x, channels) - lumaAt(below, x, channels);
+
+            count++;
+            sum += center;
+            sum_sq += center * center;
+            if (std::abs(laplacian) >= config_.edge_threshold) {
+                edges++;
+            }
+        }
+    }
+
+    if (count == 0) {
+        return verdict;
+    }
+
+    verdict.mean = static_cast<int>(sum / count);
+    // В double: count * sum_sq переполняет int64 уже на полнокадровой выборке крупных снимков
+    const double mean = static_cast<double>(sum) / count;
+    const double variance = std::max(static_cast<double>(sum_sq) / count - mean * mean, 0.0);
+    verdict.stddev = static_cast<int>(std::sqrt(variance));
+    verdict.edge_per_mille = static_cast<int>(edges * 1000 / count);
+
+    if (verdict.mean < config_.min_mean || verdict.mean > config_.max_mean) {
+        verdict.reason = REJECTED_EXPOSURE;
+    } else if (variance < static_cast<double>(config_.min_stddev) * config_.min_stddev) {
+        verdict.reason = REJECTED_BLANK;
+    } else if (edges * 1000 < count * config_.min_edge_per_mille) {
+        verdict.reason = REJECTED_BLURRY;
+    }
+
+    verdict.passed = verdict.reason == PASSED;
+    return verdict;
+}
@@ -0,0 +1,72 @@
+#ifndef QR_READER_QUALITY_GATE_H
+#define QR_READER_QUALITY_GATE_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Дешёвый предварительный отсев кадров, на которых декодирование заведомо
+// не найдёт код: пустых, пересвеченных/тёмных и размытых. Считается по
+// разреженной сетке отсчётов в целочисленной арифметике, без копий кадра.
+class QualityGate {
+public:
+    struct Config {
+        int target_samples = 65536;     // примерное число отсчётов сетки
+        int min_mean = 8;               // средняя яркость ниже — кадр тёмный
+        int max_mean = 247;             // выше — пересвечен
+        int min_stddev = 6;             // СКО яркости ниже — пустой кадр
+        int edge_threshold = 24;        // |лапласиан| отсчёта, начиная с которого он краевой
+        int min_edge_per_mille = 1;     // минимальная доля краевых отсчётов, ‰
+    };
+
+    enum Reason {
+        PASSED,
+        REJECTED_EXPOSURE,
+        REJECTED_BLANK,
+        REJECTED_BLURRY
+    };
+
+    struct Verdict {
+        bool passed = true;
+        Reason reason = PASSED;
+        int mean = 0;
+        int stddev = 0;
+        int edge_per_mille = 0;
+    };
+
+    struct GateStats {
+        int frames_checked = 0;
+        int frames_rejected = 0;
+        int rejected_exposure = 0;
+        int rejected_blank = 0;
+        int rejected_blurry = 0;
+        double gate_ms = 0.0;
+        // Время неудачных декодирований пропущенных кадров — оценка цены отсеянного
+        int failed_decodes = 0;
+        double failed_decode_ms = 0.0;
+
+        double getRejectRate() const;
+        // Оценка сэкономленного CPU за вычетом стоимости самой проверки
+        double getEstimatedSavedMs() const;
+        void merge(const GateStats& other);
+    };
+
+    QualityGate();
+    explicit QualityGate(const Config& config);
+
+    Verdict evaluate(const cv::Mat& image);
+    void recordDecode(double ms, bool success);
+
+    const Config& getConfig() const;
+    const GateStats& getStats() const;
+    void resetStats();
+
+    static std::string getReasonName(Reason reason);
+
+private:
+    Config config_;
+    GateStats stats_;
+
+    Verdict measure(const cv::Mat& image) const;
+};
+
+#endif // QR_READER_QUALITY_GATE_H
@@ -0,0 +1,98 @@
+#include "decode_client.h"
+#include <unistd.h>
+
+DecodeClient::~DecodeClient() {
+    close();
+}
+
+bool DecodeClient::connect(const std::string& endpoint) {
+    close();
+
+    decode_protocol::Endpoint parsed;
+    if (!decode_protocol::parseEndpoint(endpoint, parsed)) {
+        error_ = "Invalid endpoint: " + endpoint;
+        return false;
+    }
+    fd_ = decode_protocol::connectTo(parsed, error_);
+    return fd_ >= 0;
+}
+
+bool DecodeClient::isConnected() const {
+    return fd_ >= 0;
+}
+
+void DecodeClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+DecodeClient::Response DecodeClient::decodeEncoded(const uchar* data, size_t size, bool multi) {
+    decode_protocol::RequestHeader header;
+    header.kind = decode_protocol::PAYLOAD_ENCODED;
+    header.flags = multi ? decode_protocol::FLAG_MULTI : 0;
+    header.payload_size = static_cast<uint32_t>(size);
+    return roundTrip(header, data);
+}
+
+DecodeClient::Response DecodeClient::decodeGray(const cv::Mat& gray, bool multi) {
+    if (gray.empty() || gray.type() != CV_8UC1) {
+        Response response;
+        response.error_message = "Expected a non-empty CV_8UC1 image";
+        return response;
+    }
+
+    decode_protocol::RequestHeader header;
+    header.kind = decode_protocol::PAYLOAD_GRAY;
+    header.flags = multi ? decode_protocol::FLAG_MULTI : 0;
+    header.width = static_cast<uint32_t>(gray.cols);
+    header.height = static_cast<uint32_t>(gray.rows);
+    header.stride = static_cast<uint32_t>(gray.step[0]);
+    // Хвост после последней строки не передаём — его может не быть у вырезки
+    header.payload_size = header.stride * (header.height - 1) + header.width;
+    return roundTrip(header, gray.data);
+}
+
+const std::string& DecodeClient::getError() const {
+    return error_;
+}
+
+DecodeClient::Response DecodeClient::roundTrip(decode_protocol::RequestHeader& header, const uchar* payload) {
+    Response response;
+    if (fd_ < 0) {
+        response.error_message = "Not connected";
+        return response;
+    }
+
+    header.request_id = next_request_id_++;
+    if (!decode_protocol::writeFrame(fd_, &header, sizeof(header), payload, header.payload_size)) {
+        response.error_message = "Failed to send request";
+        close();
+        return response;
+    }
+
+    decode_protocol::ResponseHeader reply;
+    if (!decode_protocol::readExact(fd_, &reply, sizeof(reply)) || reply.magic != decode_protocol::RESPONSE_MAGIC) {
+        response.error_message = "Failed to read response";
+        close();
+        return response;
+    }
+
+    if (reply.payload_size > decode_protocol::MAX_RESPONSE_PAYLOAD) {
+        response.error_message = "Response too large: " + std::to_string(reply.payload_size) + " bytes";
+        close();
+        return response;
+    }
+
+    response.body.resize(reply.payload_size);
+    if (!decode_protocol::readExact(fd_, &response.body[0], response.body.size())) {
+        response.error_message = "Truncated response";
+        close();
+        return response;
+    }
+
+    response.success = true;
+    response.status = reply.status;
+    return response;
+}
@@ -0,0 +1,45 @@
+#ifndef QR_READER_DECODE_CLIENT_H
+#define QR_READER_DECODE_CLIENT_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include "decode_protocol.h"
+
+// Синхронный клиент DecodeServer: один запрос — один ответ по одному соединению.
+// Для параллельной нагрузки заводится по клиенту на поток.
+class DecodeClient {
+public:
+    struct Response {
+        bool success = false;           // ответ получен (не путать со статусом декодирования)
+        uint32_t status = decode_protocol::STATUS_BAD_REQUEST;
+        std::string body;               // запись результата в формате JSON Lines
+        std::string error_message;
+    };
+
+    DecodeClient() = default;
+    ~DecodeClient();
+
+    DecodeClient(const DecodeClient&) = delete;
+    DecodeClient& operator=(const DecodeClient&) = delete;
+
+    bool connect(const std::string& endpoint);
+    bool isConnected() const;
+    void close();
+
+    // Сжатое изображение как есть, без перекодирования
+    Response decodeEncoded(const uchar* data, size_t size, bool multi = false);
+    // Одноканальный кадр отправляется строками исходного буфера с его шагом, без копии
+    Response decodeGray(const cv::Mat& gray, bool multi = false);
+
+    const std::string& getError() const;
+
+private:
+    int fd_ = -1;
+    uint32_t next_request_id_ = 1;
+    std::string error_;
+
+    Response roundTrip(decode_protocol::RequestHeader& header, const uchar* payload);
+};
+
+#endif // QR_READER_DECODE_CLIENT_H
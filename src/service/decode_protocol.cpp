@@ -0,0 +1,265 @@
+#include "decode_protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace decode_protocol {
+
+namespace {
+
+const int LISTEN_BACKLOG = 128;
+const size_t READ_CHUNK_BYTES = 256 * 1024;
+
+// Закрытый клиентом сокет не должен убивать процесс через SIGPIPE
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+bool fillUnixAddress(const std::string& path, sockaddr_un& address, std::string& error) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        error = "Invalid unix socket path: " + path;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+sockaddr_in loopbackAddress(int port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// Перед bind убираем только мёртвый сокет от прошлого запуска. Обычный файл по этому
+// пути или сокет живого сервера не трогаем — это ошибка конфигурации
+bool removeStaleSocket(const std::string& path, std::string& error) {
+    struct stat info;
+    if (::lstat(path.c_str(), &info) != 0) {
+        if (errno == ENOENT) return true;
+        error = systemError("lstat " + path);
+        return false;
+    }
+    if (!S_ISSOCK(info.st_mode)) {
+        error = "Path exists and is not a socket: " + path;
+        return false;
+    }
+
+    sockaddr_un address;
+    if (!fillUnixAddress(path, address, error)) {
+        return false;
+    }
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) {
+        error = systemError("socket");
+        return false;
+    }
+    bool alive = ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    int connect_errno = errno;
+    ::close(probe);
+
+    if (alive) {
+        error = "Another server is already listening on " + path;
+        return false;
+    }
+    if (connect_errno != ECONNREFUSED) {
+        errno = connect_errno;
+        error = systemError("connect " + path);
+        return false;
+    }
+    if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+        error = systemError("unlink " + path);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseEndpoint(const std::string& address, Endpoint& endpoint) {
+    endpoint = Endpoint();
+    if (address.compare(0, 4, "tcp:") == 0) {
+        endpoint.is_tcp = true;
+        try {
+            endpoint.port = std::stoi(address.substr(4));
+        } catch (const std::exception&) {
+            return false;
+        }
+        return endpoint.port > 0 && endpoint.port < 65536;
+    }
+
+    endpoint.path = address.compare(0, 5, "unix:") == 0 ? address.substr(5) : address;
+    return !endpoint.path.empty();
+}
+
+int listenOn(const Endpoint& endpoint, std::string& error) {
+    int fd = ::socket(endpoint.is_tcp ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        error = systemError("socket");
+        return -1;
+    }
+
+    int result;
+    if (endpoint.is_tcp) {
+        int reuse = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address = loopbackAddress(endpoint.port);
+        result = ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } else {
+        sockaddr_un address;
+        if (!fillUnixAddress(endpoint.path, address, error)) {
+            ::close(fd);
+            return -1;
+        }
+        // Файл сокета от прошлого запуска мешает bind
+        if (!removeStaleSocket(endpoint.path, error)) {
+            ::close(fd);
+            return -1;
+        }
+        result = ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+
+    if (result != 0 || ::listen(fd, LISTEN_BACKLOG) != 0) {
+        error = systemError("bind/listen");
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connectTo(const Endpoint& endpoint, std::string& error) {
+    int fd = ::socket(endpoint.is_tcp ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        error = systemError("socket");
+        return -1;
+    }
+
+    configureConnection(fd, endpoint);
+
+    int result;
+    if (endpoint.is_tcp) {
+        sockaddr_in address = loopbackAddress(endpoint.port);
+        result = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } else {
+        sockaddr_un address;
+        if (!fillUnixAddress(endpoint.path, address, error)) {
+            ::close(fd);
+            return -1;
+        }
+        result = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+
+    if (result != 0) {
+        error = systemError("connect");
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void configureConnection(int fd, const Endpoint& endpoint) {
+    if (endpoint.is_tcp) {
+        // Запросы и ответы мелкие и идут по одному — Нейгл только добавил бы задержку
+        int no_delay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    }
+}
+
+void setSendTimeout(int fd, int timeout_ms) {
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+bool readExact(int fd, void* data, size_t size) {
+    auto* ptr = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::recv(fd, ptr, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        ptr += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool readInto(int fd, std::vector<unsigned char>& buffer, size_t size) {
+    buffer.clear();
+    while (buffer.size() < size) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + std::min(READ_CHUNK_BYTES, size - offset));
+        if (!readExact(fd, buffer.data() + offset, buffer.size() - offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeExact(int fd, const void* data, size_t size) {
+    const auto* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = ::send(fd, ptr, size, SEND_FLAGS);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        ptr += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool writeFrame(int fd, const void* header, size_t header_size, const void* body, size_t body_size) {
+    iovec parts[2];
+    parts[0].iov_base = const_cast<void*>(header);
+    parts[0].iov_len = header_size;
+    parts[1].iov_base = const_cast<void*>(body);
+    parts[1].iov_len = body_size;
+
+    iovec* pending = parts;
+    int count = body_size > 0 ? 2 : 1;
+    while (count > 0) {
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = pending;
+        message.msg_iovlen = count;
+
+        ssize_t sent = ::sendmsg(fd, &message, SEND_FLAGS);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+
+        // Частичная отправка: пропускаем ушедшие части и сдвигаем начало текущей
+        size_t remaining = static_cast<size_t>(sent);
+        while (count > 0 && remaining >= pending->iov_len) {
+            remaining -= pending->iov_len;
+            ++pending;
+            --count;
+        }
+        if (count > 0) {
+            pending->iov_base = static_cast<char*>(pending->iov_base) + remaining;
+            pending->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+} // namespace decode_protocol
@@ -0,0 +1,87 @@
+#ifndef QR_READER_DECODE_PROTOCOL_H
+#define QR_READER_DECODE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Протокол локального сервиса декодирования. Клиент шлёт кадр запроса:
+// заголовок RequestHeader и payload_size байт — сжатое изображение (PNG/JPEG/...)
+// или сырая плоскость оттенков серого height строк по stride байт. Ответ — заголовок
+// ResponseHeader и запись результата в формате JSON Lines. Числа в порядке байтов хоста:
+// сервис рассчитан только на клиентов той же машины. По одному соединению можно слать
+// несколько запросов подряд, не дожидаясь ответов; ответы сопоставляются по request_id.
+namespace decode_protocol {
+
+const uint32_t REQUEST_MAGIC = 0x51525251;     // "QRRQ"
+const uint32_t RESPONSE_MAGIC = 0x53525251;    // "QRRS"
+
+enum PayloadKind : uint8_t {
+    PAYLOAD_ENCODED = 0,
+    PAYLOAD_GRAY = 1
+};
+
+enum RequestFlags : uint8_t {
+    FLAG_MULTI = 1 << 0         // искать все коды кадра
+};
+
+enum Status : uint32_t {
+    STATUS_DECODED = 0,
+    STATUS_NOT_FOUND = 1,
+    STATUS_BAD_REQUEST = 2
+};
+
+struct RequestHeader {
+    uint32_t magic = REQUEST_MAGIC;
+    uint32_t request_id = 0;
+    uint8_t kind = PAYLOAD_ENCODED;
+    uint8_t flags = 0;
+    uint16_t reserved = 0;
+    uint32_t width = 0;             // только для PAYLOAD_GRAY
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    uint32_t payload_size = 0;
+};
+
+// Предел тела ответа на стороне клиента: запись JSON Lines даже со многими кодами на порядки
+// меньше, а больший размер означает испорченный поток, а не настоящий ответ
+const uint32_t MAX_RESPONSE_PAYLOAD = 16u << 20;
+
+struct ResponseHeader {
+    uint32_t magic = RESPONSE_MAGIC;
+    uint32_t request_id = 0;
+    uint32_t status = STATUS_DECODED;
+    uint32_t payload_size = 0;
+};
+
+// Адрес: "unix:/path/to.sock", "tcp:PORT" (только 127.0.0.1) или просто путь сокета
+struct Endpoint {
+    bool is_tcp = false;
+    std::string path;
+    int port = 0;
+};
+
+bool parseEndpoint(const std::string& address, Endpoint& endpoint);
+
+// Сокеты возвращаются в блокирующем режиме; -1 и error — при ошибке
+int listenOn(const Endpoint& endpoint, std::string& error);
+int connectTo(const Endpoint& endpoint, std::string& error);
+// Настройка соединения с обеих сторон: для TCP отключает алгоритм Нейгла
+void configureConnection(int fd, const Endpoint& endpoint);
+// Блокирующая отправка дольше timeout_ms завершается ошибкой, 0 = без ограничения
+void setSendTimeout(int fd, int timeout_ms);
+
+// Читают и пишут ровно size байт, повторяя при частичных операциях и EINTR
+bool readExact(int fd, void* data, size_t size);
+// Как readExact, но буфер растёт по мере прихода данных: заявленный в заголовке размер
+// не выделяется заранее, пока клиент не прислал сами байты
+bool readInto(int fd, std::vector<unsigned char>& buffer, size_t size);
+bool writeExact(int fd, const void* data, size_t size);
+// Заголовок и тело одним sendmsg: кадр уходит одним сегментом, а не двумя send,
+// второй из которых при Нейгле и отложенном ACK ждал бы около 40 мс
+bool writeFrame(int fd, const void* header, size_t header_size, const void* body, size_t body_size);
+
+} // namespace decode_protocol
+
+#endif // QR_READER_DECODE_PROTOCOL_H
@@ -0,0 +1,327 @@
+#include "decode_server.h"
+#include "shutdown_signal.h"
+#include "../io/image_loader.h"
+#include "../io/result_stream_writer.h"
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+#include <algorithm>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const int ACCEPT_POLL_MS = 200;
+
+} // namespace
+
+DecodeServer::Connection::~Connection() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+DecodeServer::DecodeServer() : DecodeServer(Config()) {
+}
+
+DecodeServer::DecodeServer(const Config& config)
+    : config_(config), intake_(config.queue_capacity), batches_(config.num_workers > 0 ? config.num_workers : 4) {
+}
+
+DecodeServer::~DecodeServer() {
+    stop();
+}
+
+bool DecodeServer::run() {
+    ScopedTimer timer("DecodeServer::run");
+
+    decode_protocol::Endpoint& endpoint = endpoint_;
+    if (!decode_protocol::parseEndpoint(config_.endpoint, endpoint)) {
+        error_ = "Invalid endpoint: " + config_.endpoint;
+        QR_LOG_ERROR(error_);
+        return false;
+    }
+
+    int listen_fd = decode_protocol::listenOn(endpoint, error_);
+    if (listen_fd < 0) {
+        QR_LOG_ERROR("Cannot listen on " + config_.endpoint + ": " + error_);
+        return false;
+    }
+
+    int num_workers = config_.num_workers;
+    if (num_workers <= 0) {
+        num_workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    // Параллелим по запросам — внутренний пул OpenCV только мешает
+    int previous_cv_threads = cv::getNumThreads();
+    if (num_workers > 1) {
+        cv::setNumThreads(1);
+    }
+
+    std::thread dispatcher(&DecodeServer::dispatchLoop, this);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_workers; ++i) {
+        workers.emplace_back(&DecodeServer::workerLoop, this);
+    }
+
+    QR_LOG_INFO("Decode server listening on " + config_.endpoint + " with " + std::to_string(num_workers) +
+                " detectors, batches up to " + std::to_string(config_.max_batch));
+
+    std::vector<Reader> readers;
+    acceptLoop(listen_fd, readers);
+
+    // Новые соединения не принимаются; читатели будятся и отдают уже принятые запросы
+    ::close(listen_fd);
+    if (!endpoint.is_tcp) {
+        ::unlink(endpoint.path.c_str());
+    }
+    for (auto& reader : readers) {
+        ::shutdown(reader.connection->fd, SHUT_RD);
+    }
+    for (auto& reader : readers) {
+        reader.thread.join();
+    }
+    readers.clear();
+
+    intake_.close();
+    dispatcher.join();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    cv::setNumThreads(previous_cv_threads);
+    return true;
+}
+
+void DecodeServer::stop() {
+    stop_requested_ = true;
+}
+
+DecodeServer::ServerStats DecodeServer::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+const std::string& DecodeServer::getError() const {
+    return error_;
+}
+
+bool DecodeServer::shouldStop() const {
+    return stop_requested_ || ShutdownSignal::isRequested();
+}
+
+void DecodeServer::acceptLoop(int listen_fd, std::vector<Reader>& readers) {
+    while (!shouldStop()) {
+        pollfd descriptor{listen_fd, POLLIN, 0};
+        if (::poll(&descriptor, 1, ACCEPT_POLL_MS) > 0) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0 && readers.size() >= static_cast<size_t>(std::max(1, config_.max_connections))) {
+                // Поток на соединение — число соединений ограничено, лишние закрываем сразу
+                ::close(fd);
+                QR_LOG_WARNING("Connection limit reached (" + std::to_string(readers.size()) + "), rejecting client");
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats_.rejected_connections++;
+            } else if (fd >= 0) {
+                decode_protocol::configureConnection(fd, endpoint_);
+                decode_protocol::setSendTimeout(fd, config_.send_timeout_ms);
+                Reader reader;
+                reader.connection = std::make_shared<Connection>();
+                reader.connection->fd = fd;
+                reader.finished = std::make_shared<std::atomic<bool>>(false);
+                reader.thread = std::thread(&DecodeServer::readLoop, this, reader.connection, reader.finished);
+                readers.push_back(std::move(reader));
+
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats_.connections++;
+            }
+        }
+
+        // Потоки закрывшихся соединений собираем здесь, чтобы они не копились
+        for (auto it = readers.begin(); it != readers.end();) {
+            if (it->finished->load()) {
+                it->thread.join();
+                it = readers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void DecodeServer::readLoop(std::shared_ptr<Connection> connection, std::shared_ptr<std::atomic<bool>> finished) {
+    using namespace decode_protocol;
+
+    RequestHeader header;
+    while (readExact(connection->fd, &header, sizeof(header))) {
+        Request request;
+        request.connection = connection;
+        request.header = header;
+
+        // Без правильного заголовка граница следующего запроса неизвестна — рвём соединение
+        if (header.magic != REQUEST_MAGIC || header.payload_size > config_.max_payload_bytes) {
+            sendResponse(request, STATUS_BAD_REQUEST, "{\"error\":\"invalid request header\"}\n");
+            break;
+        }
+
+        if (!readInto(connection->fd, request.payload, header.payload_size)) {
+            break;
+        }
+        request.received_at = std::chrono::steady_clock::now();
+
+        if (!intake_.push(std::move(request))) {
+            break;
+        }
+    }
+
+    ::shutdown(connection->fd, SHUT_RD);
+    finished->store(true);
+}
+
+void DecodeServer::dispatchLoop() {
+    const auto window = std::chrono::microseconds(config_.batch_window_us);
+    const size_t max_batch = static_cast<size_t>(std::max(1, config_.max_batch));
+
+    Request request;
+    while (intake_.pop(request)) {
+        Batch batch;
+        batch.push_back(std::move(request));
+
+        // Пока есть свободные детекторы, запросы не задерживаются: уже накопившиеся
+        // делятся между ними поровну. Когда заняты все, ожидание окна ничего не стоит —
+        // пакет добирается до max_batch и дальше обрабатывается одним потоком подряд
+        size_t limit = max_batch;
+        auto deadline = std::chrono::steady_clock::now() + window;
+        int idle = idle_workers_.load();
+        if (idle > 0) {
+            size_t waiting = intake_.size() + 1;
+            limit = std::min(max_batch, (waiting + idle - 1) / idle);
+            deadline = std::chrono::steady_clock::now();
+        }
+        while (batch.size() < limit && intake_.popUntil(request, deadline)) {
+            batch.push_back(std::move(request));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.batches++;
+            stats_.avg_batch_size += (static_cast<double>(batch.size()) - stats_.avg_batch_size) / stats_.batches;
+        }
+
+        if (!batches_.push(std::move(batch))) break;
+    }
+    batches_.close();
+}
+
+void DecodeServer::workerLoop() {
+    QRDetector detector;
+    detector.setPreprocessingEnabled(config_.preprocessing_enabled);
+    detector.setPyramidLocalization(config_.pyramid_localization);
+    if (!config_.cascade_stages.empty()) {
+        detector.getPreprocessingCascade().setOrder(config_.cascade_stages);
+    }
+    detector.setGrayscaleProcessing(config_.grayscale);
+    detector.getQualityGate() = QualityGate(config_.quality_gate);
+    detector.setQualityGateEnabled(config_.quality_gate_enabled);
+    detector.setRetainProcessedImage(false);
+
+    // Прогрев до первого запроса
+    detector.warmUp();
+
+    Batch batch;
+    idle_workers_++;
+    while (batches_.pop(batch)) {
+        idle_workers_--;
+        for (auto& request : batch) {
+            handleRequest(detector, request);
+        }
+        batch.clear();
+        idle_workers_++;
+    }
+    idle_workers_--;
+}
+
+void DecodeServer::handleRequest(QRDetector& detector, Request& request) {
+    using namespace decode_protocol;
+    ScopedTimer timer("DecodeServer::handleRequest");
+
+    const RequestHeader& header = request.header;
+    cv::Mat image;
+    if (header.kind == PAYLOAD_GRAY) {
+        bool valid = header.width > 0 && header.height > 0 && header.stride >= header.width &&
+                     static_cast<uint64_t>(header.stride) * (header.height - 1) + header.width <= header.payload_size;
+        if (valid) {
+            // Плоскость клиента используется на месте, stride передаётся как шаг строки
+            image = cv::Mat(static_cast<int>(header.height), static_cast<int>(header.width), CV_8UC1,
+                            request.payload.data(), header.stride);
+        }
+    } else if (header.kind == PAYLOAD_ENCODED) {
+        ImageLoader::DecodeOptions options;
+        options.grayscale = config_.grayscale;
+        auto load = ImageLoader::loadFromMemory(request.payload.data(), request.payload.size(), "socket", options);
+        if (load.success) {
+            image = load.image;
+        }
+    }
+
+    if (image.empty()) {
+        sendResponse(request, STATUS_BAD_REQUEST, "{\"error\":\"cannot decode payload\"}\n");
+        return;
+    }
+
+    bool multi = config_.multiple_qr_enabled || (header.flags & FLAG_MULTI) != 0;
+    detector.setMultipleQRDetection(multi);
+    QRDetector::DetectionResult result = detector.detectFromImage(image);
+    image.release();
+
+    std::string body;
+    ResultStreamWriter::appendRecord(body, ResultStreamWriter::JSONL, "request#" + std::to_string(header.request_id),
+                                     result, ResultStreamWriter::detectionTimeOf(result));
+    sendResponse(request, result.success ? STATUS_DECODED : STATUS_NOT_FOUND, body);
+}
+
+void DecodeServer::sendResponse(Request& request, uint32_t status, const std::string& body) {
+    decode_protocol::ResponseHeader header;
+    header.request_id = request.header.request_id;
+    header.status = status;
+    header.payload_size = static_cast<uint32_t>(body.size());
+
+    bool dropped = false;
+    {
+        // Ответы одного соединения пишут разные рабочие потоки — кадр не должен разорваться
+        Connection& connection = *request.connection;
+        std::lock_guard<std::mutex> lock(connection.write_mutex);
+        if (!connection.broken &&
+            !decode_protocol::writeFrame(connection.fd, &header, sizeof(header), body.data(), body.size())) {
+            // Клиент ушёл или не читает ответы (таймаут отправки): рвём соединение,
+            // чтобы его остальные запросы не занимали рабочие потоки, и будим читателя
+            QR_LOG_DEBUG("Dropping client before response " + std::to_string(header.request_id));
+            connection.broken = true;
+            ::shutdown(connection.fd, SHUT_RDWR);
+            dropped = true;
+        }
+    }
+
+    // Буфер запроса больше не нужен; соединение закроется с последней ссылкой на него
+    request.payload = std::vector<uchar>();
+    request.connection.reset();
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (dropped) {
+        stats_.dropped_connections++;
+    }
+    stats_.requests++;
+    if (status == decode_protocol::STATUS_DECODED) {
+        stats_.decoded++;
+    } else if (status == decode_protocol::STATUS_BAD_REQUEST) {
+        stats_.bad_requests++;
+    }
+    if (request.received_at.time_since_epoch().count() > 0) {
+        double latency_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - request.received_at).count();
+        // Отклонённые до чтения тела запросы не хронометрируются и в среднее не входят
+        timed_requests_++;
+        total_latency_ms_ += latency_ms;
+        stats_.avg_latency_ms = total_latency_ms_ / timed_requests_;
+        stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency_ms);
+    }
+}
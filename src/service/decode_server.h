@@ -0,0 +1,120 @@
+#ifndef QR_READER_DECODE_SERVER_H
+#define QR_READER_DECODE_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "decode_protocol.h"
+#include "../core/qr_detector.h"
+#include "../processors/quality_gate.h"
+#include "../utils/bounded_queue.h"
+
+// Сервис декодирования на Unix-сокете или localhost TCP (протокол — decode_protocol.h).
+// Каждое соединение читает свой поток; запросы всех соединений сходятся в общую очередь,
+// диспетчер собирает из неё микропакеты и отдаёт их пулу прогретых детекторов:
+// при свободных детекторах — сразу, при занятых всех — до max_batch запросов
+// или до истечения окна batch_window_us после первого.
+// Изображение декодируется прямо из принятого буфера, сырая серая плоскость
+// оборачивается в cv::Mat без копирования.
+class DecodeServer {
+public:
+    struct Config {
+        std::string endpoint = "unix:/tmp/qr_reader.sock";
+        int num_workers = 0;                // 0 = hardware_concurrency()
+        int max_batch = 16;
+        int batch_window_us = 500;          // сколько ждать добора пакета после первого запроса
+        size_t queue_capacity = 256;        // запросов в ожидании диспетчера
+        size_t max_payload_bytes = 64u << 20;
+        int max_connections = 64;           // сверх этого новые соединения сразу закрываются
+        // Клиент, не читающий ответы дольше этого, отключается, а не держит рабочий поток
+        int send_timeout_ms = 5000;
+        bool preprocessing_enabled = true;
+        bool multiple_qr_enabled = false;   // все коды в каждом запросе, даже без FLAG_MULTI
+        bool pyramid_localization = false;
+        std::vector<std::string> cascade_stages;
+        bool grayscale = true;              // сжатые изображения декодируются сразу в один канал
+        bool quality_gate_enabled = false;
+        QualityGate::Config quality_gate;
+    };
+
+    struct ServerStats {
+        int64_t connections = 0;
+        int64_t rejected_connections = 0;   // отклонены сверх max_connections
+        int64_t dropped_connections = 0;    // отключены по таймауту отправки
+        int64_t requests = 0;
+        int64_t decoded = 0;
+        int64_t bad_requests = 0;
+        int64_t batches = 0;
+        double avg_batch_size = 0.0;
+        double avg_latency_ms = 0.0;        // от приёма запроса до отправки ответа
+        double max_latency_ms = 0.0;
+    };
+
+    DecodeServer();
+    explicit DecodeServer(const Config& config);
+    ~DecodeServer();
+
+    DecodeServer(const DecodeServer&) = delete;
+    DecodeServer& operator=(const DecodeServer&) = delete;
+
+    // Блокирует до stop() или сигнала остановки (ShutdownSignal);
+    // false — не удалось открыть сокет
+    bool run();
+    void stop();
+
+    ServerStats getStats() const;
+    const std::string& getError() const;
+
+private:
+    // Владеет дескриптором; закрывается, когда ушёл последний ответ и отпустил чтение
+    struct Connection {
+        int fd = -1;
+        std::mutex write_mutex;
+        bool broken = false;            // отправка не удалась — остальные ответы не пишем
+        ~Connection();
+    };
+
+    struct Request {
+        std::shared_ptr<Connection> connection;
+        decode_protocol::RequestHeader header;
+        std::vector<uchar> payload;
+        std::chrono::steady_clock::time_point received_at;
+    };
+
+    using Batch = std::vector<Request>;
+
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<Connection> connection;
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+
+    Config config_;
+    decode_protocol::Endpoint endpoint_;
+    std::string error_;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<int> idle_workers_{0};
+
+    BoundedQueue<Request> intake_;
+    BoundedQueue<Batch> batches_;
+
+    mutable std::mutex stats_mutex_;
+    ServerStats stats_;
+    double total_latency_ms_ = 0.0;
+    int64_t timed_requests_ = 0;        // запросы с известным временем приёма, знаменатель avg_latency_ms
+
+    bool shouldStop() const;
+    void acceptLoop(int listen_fd, std::vector<Reader>& readers);
+    void readLoop(std::shared_ptr<Connection> connection, std::shared_ptr<std::atomic<bool>> finished);
+    void dispatchLoop();
+    void workerLoop();
+    void handleRequest(QRDetector& detector, Request& request);
+    void sendResponse(Request& request, uint32_t status, const std::string& body);
+};
+
+#endif // QR_READER_DECODE_SERVER_H
@@ -0,0 +1,26 @@
+#include "shutdown_signal.h"
+#include <atomic>
+#include <csignal>
+
+namespace {
+
+std::atomic<bool> shutdown_requested{false};
+
+void handleShutdownSignal(int) {
+    shutdown_requested.store(true, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void ShutdownSignal::install() {
+    std::signal(SIGTERM, handleShutdownSignal);
+    std::signal(SIGINT, handleShutdownSignal);
+}
+
+bool ShutdownSignal::isRequested() {
+    return shutdown_requested.load(std::memory_order_relaxed);
+}
+
+void ShutdownSignal::request() {
+    shutdown_requested.store(true, std::memory_order_relaxed);
+}
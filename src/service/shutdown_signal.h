@@ -0,0 +1,14 @@
+#ifndef QR_READER_SHUTDOWN_SIGNAL_H
+#define QR_READER_SHUTDOWN_SIGNAL_H
+
+// Флаг мягкой остановки резидентных режимов по SIGTERM/SIGINT.
+// Обработчик только взводит атомарный флаг; циклы сервисов периодически его проверяют
+// и завершаются после обработки уже принятой работы.
+class ShutdownSignal {
+public:
+    static void install();
+    static bool isRequested();
+    static void request();
+};
+
+#endif // QR_READER_SHUTDOWN_SIGNAL_H
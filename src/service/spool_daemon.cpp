@@ -0,0 +1,426 @@
+#include "spool_daemon.h"
+#include "shutdown_signal.h"
+#include "qr_reader_config.h"
+#include "../io/result_writer.h"
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <thread>
+
+#ifdef QR_READER_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// rename() между файловыми системами невозможен: копируем под скрытым именем в целевой каталог,
+// переименовываем уже в его пределах и только потом удаляем исходный файл
+std::error_code copyThenRemove(const fs::path& source, const fs::path& target) {
+    fs::path staging = target.parent_path() / ("." + target.filename().string() + ".part");
+    std::error_code ec;
+    fs::copy_file(source, staging, fs::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        fs::rename(staging, target, ec);
+    }
+    if (ec) {
+        std::error_code ignored;
+        fs::remove(staging, ignored);
+        return ec;
+    }
+
+    fs::remove(source, ec);
+    if (ec) {
+        // Исходный файл остался в спуле — копия в done/failed была бы дублем
+        std::error_code ignored;
+        fs::remove(target, ignored);
+    }
+    return ec;
+}
+
+} // namespace
+
+SpoolDaemon::SpoolDaemon() : SpoolDaemon(Config()) {
+}
+
+SpoolDaemon::SpoolDaemon(const Config& config) : config_(config) {
+    if (config_.done_directory.empty()) {
+        config_.done_directory = (fs::path(config_.spool_directory) / "done").string();
+    }
+    if (config_.failed_directory.empty()) {
+        config_.failed_directory = (fs::path(config_.spool_directory) / "failed").string();
+    }
+}
+
+bool SpoolDaemon::run() {
+    stop_requested_ = false;
+    if (!prepareDirectories()) {
+        return false;
+    }
+
+    if (!config_.results.path.empty()) {
+        writer_.reset(new ResultStreamWriter(config_.results));
+        if (!writer_->open()) {
+            writer_.reset();
+        }
+    }
+
+    int num_workers = config_.num_workers;
+    if (num_workers <= 0) {
+        num_workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    // Параллелим по файлам, как и пакетный конвейер
+    int previous_cv_threads = cv::getNumThreads();
+    if (num_workers > 1) {
+        cv::setNumThreads(1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BoundedQueue<SpoolFile> queue(config_.queue_capacity);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_workers; ++i) {
+        workers.emplace_back(&SpoolDaemon::workerLoop, this, std::ref(queue));
+    }
+
+    QR_LOG_INFO("Watching spool " + config_.spool_directory + " with " + std::to_string(num_workers) +
+                " detectors (done: " + config_.done_directory + ", failed: " + config_.failed_directory + ")");
+    watchLoop(queue);
+
+    // Новые файлы больше не принимаются; всё, что уже в очереди, дорабатывается
+    QR_LOG_INFO("Draining " + std::to_string(queue.size()) + " queued files before shutdown");
+    queue.close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (writer_) {
+        writer_->close();
+        writer_.reset();
+    }
+    cv::setNumThreads(previous_cv_threads);
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.uptime_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void SpoolDaemon::stop() {
+    stop_requested_ = true;
+}
+
+SpoolDaemon::DaemonStats SpoolDaemon::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+bool SpoolDaemon::shouldStop() const {
+    return stop_requested_ || ShutdownSignal::isRequested();
+}
+
+bool SpoolDaemon::prepareDirectories() {
+    if (!fs::is_directory(config_.spool_directory)) {
+        QR_LOG_ERROR("Spool directory does not exist: " + config_.spool_directory);
+        return false;
+    }
+
+    for (const std::string& directory : {config_.done_directory, config_.failed_directory}) {
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (ec) {
+            QR_LOG_ERROR("Cannot create directory " + directory + ": " + ec.message());
+            return false;
+        }
+    }
+    return true;
+}
+
+void SpoolDaemon::watchLoop(BoundedQueue<SpoolFile>& queue) {
+    int fd = -1;
+#ifdef QR_READER_LINUX
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0 && inotify_add_watch(fd, config_.spool_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    if (fd < 0) {
+        QR_LOG_WARNING("inotify unavailable, falling back to polling " + config_.spool_directory);
+    }
+
+    // Наблюдение ставится до сканирования, чтобы не потерять файлы, появившиеся между ними.
+    // Найденное сканированием берётся в работу только на следующем проходе, если не изменилось
+    scanSpool(queue);
+    auto last_scan = std::chrono::steady_clock::now();
+    const auto scan_interval = std::chrono::milliseconds(config_.poll_interval_ms);
+
+    while (!shouldStop()) {
+        if (fd < 0) {
+            std::this_thread::sleep_for(scan_interval);
+        }
+#ifdef QR_READER_LINUX
+        else {
+            alignas(struct inotify_event) char buffer[16 * 1024];
+            pollfd descriptor{fd, POLLIN, 0};
+            if (::poll(&descriptor, 1, config_.poll_interval_ms) > 0) {
+                ssize_t length;
+                while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* ptr = buffer; ptr < buffer + length;) {
+                        const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+                        if (event->mask & IN_Q_OVERFLOW) {
+                            // Часть событий потеряна — досканируем каталог целиком
+                            scanSpool(queue);
+                        } else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                            enqueue(queue, event->name);
+                        }
+                        ptr += sizeof(struct inotify_event) + event->len;
+                    }
+                }
+            }
+        }
+#endif
+
+        // Без inotify сканируем всегда, с ним — пока есть файлы, ждущие повторной проверки
+        if ((fd < 0 || !unsettled_.empty()) && std::chrono::steady_clock::now() - last_scan >= scan_interval) {
+            scanSpool(queue);
+            last_scan = std::chrono::steady_clock::now();
+        }
+
+        // В простое буфер писателя не наполняется — сбрасываем его по таймеру здесь
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        if (writer_) {
+            writer_->flush();
+        }
+    }
+
+#ifdef QR_READER_LINUX
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+}
+
+void SpoolDaemon::scanSpool(BoundedQueue<SpoolFile>& queue) {
+    std::unordered_map<std::string, FileSignature> seen;
+    std::unordered_set<std::string> present;
+    std::error_code ec;
+    for (fs::directory_iterator it(config_.spool_directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code entry_error;
+        if (!it->is_regular_file(entry_error)) continue;
+
+        std::string name = it->path().filename().string();
+        if (!isCandidateName(name)) continue;
+        present.insert(it->path().string());
+
+        FileSignature signature;
+        if (!readSignature(it->path(), signature)) continue;
+
+        // Размер и mtime совпали с прошлым проходом — загрузчик файл больше не пишет
+        auto previous = unsettled_.find(name);
+        if (previous != unsettled_.end() && previous->second.size == signature.size &&
+            previous->second.modified == signature.modified) {
+            enqueue(queue, name);
+        } else {
+            seen[name] = signature;
+        }
+    }
+    unsettled_ = std::move(seen);
+
+    // Неперенесённые файлы, которые уже убрали из спула вручную, больше не помним
+    if (!ec) {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        for (auto it = unmovable_.begin(); it != unmovable_.end();) {
+            it = present.count(it->first) ? std::next(it) : unmovable_.erase(it);
+        }
+    }
+}
+
+void SpoolDaemon::enqueue(BoundedQueue<SpoolFile>& queue, const std::string& name) {
+    if (!isCandidateName(name)) {
+        return;
+    }
+
+    std::string path = (fs::path(config_.spool_directory) / name).string();
+    {
+        // Файл мог попасть и в начальное сканирование, и в событие inotify
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        auto unmovable = unmovable_.find(path);
+        if (unmovable != unmovable_.end()) {
+            // Тот же файл, что не удалось перенести, — иначе каждый проход декодировал бы его снова
+            FileSignature current;
+            if (!readSignature(path, current) || (current.size == unmovable->second.size &&
+                                                  current.modified == unmovable->second.modified)) {
+                return;
+            }
+            unmovable_.erase(unmovable);
+        }
+        if (!in_flight_.insert(path).second) {
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.files_seen++;
+    }
+
+    // Полная очередь задерживает приём событий — inotify копит их в ядре
+    if (!queue.push({path, std::chrono::steady_clock::now()})) {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        in_flight_.erase(path);
+    }
+}
+
+void SpoolDaemon::workerLoop(BoundedQueue<SpoolFile>& queue) {
+    QRDetector detector;
+    detector.setPreprocessingEnabled(config_.preprocessing_enabled);
+    detector.setMultipleQRDetection(config_.multiple_qr_enabled);
+    detector.setPyramidLocalization(config_.pyramid_localization);
+    detector.setGrayscaleProcessing(config_.decode.grayscale);
+    if (!config_.cascade_stages.empty()) {
+        detector.getPreprocessingCascade().setOrder(config_.cascade_stages);
+    }
+    detector.getQualityGate() = QualityGate(config_.quality_gate);
+    detector.setQualityGateEnabled(config_.quality_gate_enabled);
+    detector.setRetainProcessedImage(false);
+
+    // Прогрев: платим за первые выделения OpenCV до первого файла
+    detector.warmUp();
+
+    SpoolFile file;
+    while (queue.pop(file)) {
+        processFile(detector, file);
+    }
+}
+
+void SpoolDaemon::processFile(QRDetector& detector, const SpoolFile& file) {
+    ScopedTimer timer("SpoolDaemon::processFile");
+
+    std::error_code exists_error;
+    if (!fs::exists(file.path, exists_error)) {
+        // Запоздалое событие о файле, который уже обработан и перенесён
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        in_flight_.erase(file.path);
+        return;
+    }
+
+    // Файл чужой: загрузчик может переписать его во время декодирования, и обрезанное
+    // отображение уронило бы процесс по SIGBUS — читаем копию в свой буфер
+    QRDetector::DetectionResult result;
+    std::vector<uchar> bytes;
+    std::string read_error;
+    if (!ImageLoader::readFileCopy(file.path, bytes, read_error)) {
+        result.error_message = read_error;
+    } else {
+        auto load = ImageLoader::loadFromMemory(bytes.data(), bytes.size(), file.path, config_.decode);
+        if (load.success) {
+            result = detector.detectFromImage(load.image, file.path);
+            load.image.release();
+            if (!result.success && load.reduction > 1) {
+                // Как и в пакетном режиме: единственный повтор в полном размере
+                ImageLoader::DecodeOptions full_options = config_.decode;
+                full_options.reduction = 1;
+                auto full_load = ImageLoader::loadFromMemory(bytes.data(), bytes.size(), file.path, full_options);
+                if (full_load.success) {
+                    result = detector.detectFromImage(full_load.image, file.path);
+                }
+            } else if (result.success && load.reduction > 1) {
+                for (auto& point : result.bounding_box) {
+                    point *= load.reduction;
+                }
+                for (auto& code : result.codes) {
+                    for (auto& point : code.bounding_box) {
+                        point *= load.reduction;
+                    }
+                }
+            }
+        } else {
+            result.error_message = load.error_msg;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        if (writer_) {
+            writer_->write(file.path, result);
+        }
+    }
+
+    std::string moved = moveTo(file.path, result.success ? config_.done_directory : config_.failed_directory);
+    if (!writer_ && result.success && !moved.empty()) {
+        ResultWriter::saveToTextFile(result, moved + ".txt");
+    }
+
+    FileSignature stranded;
+    bool remember_stranded = moved.empty() && readSignature(file.path, stranded);
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        in_flight_.erase(file.path);
+        if (remember_stranded) {
+            unmovable_[file.path] = stranded;
+        }
+    }
+
+    double latency_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - file.seen_at).count();
+    if (result.success) {
+        QR_LOG_INFO(file.path + ": " + result.data + " (" + std::to_string(latency_ms) + " ms)");
+    } else {
+        QR_LOG_WARNING(file.path + ": " + result.error_message + " (" + std::to_string(latency_ms) + " ms)");
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.files_processed++;
+    if (result.success) {
+        stats_.successful++;
+    } else {
+        stats_.failed++;
+    }
+    total_latency_ms_ += latency_ms;
+    stats_.avg_latency_ms = total_latency_ms_ / stats_.files_processed;
+    stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency_ms);
+}
+
+std::string SpoolDaemon::moveTo(const std::string& path, const std::string& directory) {
+    fs::path source(path);
+    fs::path target = fs::path(directory) / source.filename();
+    for (int suffix = 1; fs::exists(target); ++suffix) {
+        target = fs::path(directory) / (source.stem().string() + "_" + std::to_string(suffix) +
+                                        source.extension().string());
+    }
+
+    std::error_code ec;
+    fs::rename(source, target, ec);
+    if (ec == std::errc::cross_device_link) {
+        ec = copyThenRemove(source, target);
+    }
+    if (ec) {
+        QR_LOG_ERROR("Cannot move " + path + " to " + directory + ": " + ec.message());
+        return std::string();
+    }
+    return target.string();
+}
+
+bool SpoolDaemon::readSignature(const fs::path& path, FileSignature& signature) {
+    std::error_code ec;
+    signature.size = fs::file_size(path, ec);
+    if (ec) return false;
+    signature.modified = fs::last_write_time(path, ec);
+    return !ec;
+}
+
+bool SpoolDaemon::isCandidateName(const std::string& name) {
+    // Скрытые и недописанные файлы загрузчиков пропускаем: их переименуют, и придёт IN_MOVED_TO
+    if (name.empty() || name[0] == '.') return false;
+    for (const char* suffix : {".tmp", ".part", ".partial"}) {
+        size_t length = std::char_traits<char>::length(suffix);
+        if (name.size() >= length && name.compare(name.size() - length, length, suffix) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+#ifndef QR_READER_SPOOL_DAEMON_H
+#define QR_READER_SPOOL_DAEMON_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../core/qr_detector.h"
+#include "../io/image_loader.h"
+#include "../io/result_stream_writer.h"
+#include "../utils/bounded_queue.h"
+
+// Резидентный режим: следит за каталогом-спулом и обрабатывает появляющиеся файлы.
+// Детекторы создаются один раз при запуске и прогреваются, поэтому задержка на файл —
+// время самой детекции, а не запуска процесса. Новые файлы замечаются через inotify
+// (IN_CLOSE_WRITE / IN_MOVED_TO), без него — периодическим сканированием. Из сканирования
+// файл берётся, только когда его размер и mtime не изменились между двумя проходами:
+// загрузка, которая ещё идёт, не декодируется наполовину.
+// Обработанный файл переносится в done или failed (на другую файловую систему — копированием).
+// Файл, который перенести не удалось, больше не берётся, пока не изменится. stop() и SIGTERM (через
+// ShutdownSignal) прекращают приём новых файлов; уже взятые в очередь дорабатываются.
+class SpoolDaemon {
+public:
+    struct Config {
+        std::string spool_directory;
+        std::string done_directory;     // пусто = <spool>/done
+        std::string failed_directory;   // пусто = <spool>/failed
+        int num_workers = 0;            // 0 = hardware_concurrency()
+        size_t queue_capacity = 64;
+        int poll_interval_ms = 200;     // проверка остановки; без inotify — период сканирования
+        bool preprocessing_enabled = true;
+        bool multiple_qr_enabled = false;
+        bool pyramid_localization = false;
+        std::vector<std::string> cascade_stages;
+        ImageLoader::DecodeOptions decode;
+        bool quality_gate_enabled = false;
+        QualityGate::Config quality_gate;
+        // Непустой results.path: результаты пишутся в один файл,
+        // иначе .txt кладётся рядом с файлом в done
+        ResultStreamWriter::Config results;
+    };
+
+    struct DaemonStats {
+        int64_t files_seen = 0;
+        int64_t files_processed = 0;
+        int64_t successful = 0;
+        int64_t failed = 0;
+        double avg_latency_ms = 0.0;    // от появления файла до переноса в done/failed
+        double max_latency_ms = 0.0;
+        double uptime_seconds = 0.0;
+    };
+
+    SpoolDaemon();
+    explicit SpoolDaemon(const Config& config);
+
+    // Блокирует до stop() или сигнала остановки; false — не удалось подготовить каталоги
+    bool run();
+    void stop();
+
+    DaemonStats getStats() const;
+
+private:
+    struct SpoolFile {
+        std::string path;
+        std::chrono::steady_clock::time_point seen_at;
+    };
+
+    struct FileSignature {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type modified;
+    };
+
+    Config config_;
+    std::atomic<bool> stop_requested_{false};
+
+    std::mutex in_flight_mutex_;
+    std::unordered_set<std::string> in_flight_;     // в очереди или в обработке
+    // Не удалось перенести из спула; повторно берутся, только если размер или mtime изменились
+    std::unordered_map<std::string, FileSignature> unmovable_;
+
+    // Файлы из последнего сканирования, ещё не признанные дописанными; только поток наблюдения
+    std::unordered_map<std::string, FileSignature> unsettled_;
+
+    std::mutex writer_mutex_;
+    std::unique_ptr<ResultStreamWriter> writer_;
+
+    mutable std::mutex stats_mutex_;
+    DaemonStats stats_;
+    double total_latency_ms_ = 0.0;
+
+    bool shouldStop() const;
+    bool prepareDirectories();
+    void watchLoop(BoundedQueue<SpoolFile>& queue);
+    void scanSpool(BoundedQueue<SpoolFile>& queue);
+    void enqueue(BoundedQueue<SpoolFile>& queue, const std::string& name);
+    void workerLoop(BoundedQueue<SpoolFile>& queue);
+    void processFile(QRDetector& detector, const SpoolFile& file);
+    // Путь на новом месте или пустая строка; при совпадении имён добавляется суффикс _N
+    std::string moveTo(const std::string& path, const std::string& directory);
+
+    static bool isCandidateName(const std::string& name);
+    static bool readSignature(const std::filesystem::path& path, FileSignature& signature);
+};
+
+#endif // QR_READER_SPOOL_DAEMON_H
@@ -0,0 +1,38 @@
+#include "arg_parser.h"
+#include "logger.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+
+namespace cli {
+
+bool parseIntArg(const std::string& option, const char* text, long long min_value, long long max_value,
+                 long long& value) {
+    errno = 0;
+    char* end = nullptr;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min_value || parsed > max_value) {
+        QR_LOG_ERROR("Invalid value for " + option + ": '" + text + "' (expected an integer in [" +
+                     std::to_string(min_value) + ", " + std::to_string(max_value) + "])");
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool parseDoubleArg(const std::string& option, const char* text, double min_value, double max_value,
+                    double& out) {
+    errno = 0;
+    char* end = nullptr;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !std::isfinite(parsed) ||
+        parsed < min_value || parsed > max_value) {
+        QR_LOG_ERROR("Invalid value for " + option + ": '" + text + "' (expected a number in [" +
+                     std::to_string(min_value) + ", " + std::to_string(max_value) + "])");
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+} // namespace cli
@@ -0,0 +1,30 @@
+#ifndef QR_READER_ARG_PARSER_H
+#define QR_READER_ARG_PARSER_H
+
+#include <string>
+
+// Числовые аргументы командной строки разбираются целиком и с проверкой диапазона:
+// std::stoi/stod бросали бы исключение мимо main на мусоре и молча принимали бы
+// отрицательные значения. При ошибке причина пишется в журнал, а out не меняется.
+namespace cli {
+
+bool parseIntArg(const std::string& option, const char* text, long long min_value, long long max_value,
+                 long long& value);
+
+template <typename T>
+bool parseIntArg(const std::string& option, const char* text, long long min_value, long long max_value,
+                 T& out) {
+    long long value = 0;
+    if (!parseIntArg(option, text, min_value, max_value, value)) {
+        return false;
+    }
+    out = static_cast<T>(value);
+    return true;
+}
+
+bool parseDoubleArg(const std::string& option, const char* text, double min_value, double max_value,
+                    double& out);
+
+} // namespace cli
+
+#endif // QR_READER_ARG_PARSER_H
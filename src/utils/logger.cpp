@@ -1,19 +1,303 @@
 #include "logger.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-Logger::Level Logger::current_level_ = Logger::INFO;
+namespace {
+
+std::atomic<int> current_level{Logger::INFO};
+std::atomic<bool> async_enabled{true};
+
+struct LogRecord {
+    Logger::Level level = Logger::INFO;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+// Кольцо одного потока: пишет только владелец, читает только фоновый поток,
+// поэтому хватает двух атомарных индексов без блокировок
+class LogRing {
+public:
+    static constexpr size_t CAPACITY = 1024;   // степень двойки
+
+    bool push(LogRecord&& record) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == CAPACITY) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[head & (CAPACITY - 1)] = std::move(record);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(LogRecord& record) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        record = std::move(slots_[tail & (CAPACITY - 1)]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+    int64_t takeDropped() {
+        return dropped_.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Поток-владелец завершился; пустое осиротевшее кольцо удаляется фоновым потоком
+    std::atomic<bool> orphaned{false};
+
+private:
+    std::array<LogRecord, CAPACITY> slots_;
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+    std::atomic<int64_t> dropped_{0};
+};
+
+void appendTimestamp(std::string& out, std::chrono::system_clock::time_point time) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      time.time_since_epoch()).count() % 1000);
+
+    // std::localtime возвращает общий статический буфер — из нескольких потоков нельзя
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &local);
+    out += buffer;
+    std::snprintf(buffer, sizeof(buffer), ".%03d", millis);
+    out += buffer;
+}
+
+void writeOut(const std::string& text) {
+    if (text.empty()) return;
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+// Фоновый поток, сливающий кольца всех потоков и пишущий их одной операцией на пачку
+class LogBackend {
+public:
+    static LogBackend& instance() {
+        // Намеренно не разрушается: логирование из статических деструкторов остаётся безопасным
+        static LogBackend* backend = [] {
+            auto* created = new LogBackend();
+            std::atexit([] { LogBackend::instance().shutdown(); });
+            return created;
+        }();
+        return *backend;
+    }
+
+    bool enqueue(Logger::Level level, const std::string& message) {
+        if (stopped_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        LogRing& ring = localRing();
+        bool queued = ring.push({level, std::chrono::system_clock::now(), message});
+        // Предупреждения и ошибки не ждут очередного такта фонового потока
+        if (level >= Logger::WARNING || !queued) {
+            wake_.notify_one();
+        }
+        return true;
+    }
+
+    void flush() {
+        if (stopped_.load(std::memory_order_acquire)) return;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t target = ++flush_requests_;
+        wake_.notify_one();
+        flushed_cv_.wait(lock, [&] { return flushed_ >= target || stopped_.load(); });
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopped_.load()) return;
+            stopped_.store(true, std::memory_order_release);
+        }
+        wake_.notify_one();
+        if (drain_thread_.joinable()) {
+            drain_thread_.join();
+        }
+        // Остаток, поставленный в очередь во время остановки
+        drainOnce();
+        flushed_cv_.notify_all();
+    }
+
+private:
+    static constexpr int DRAIN_INTERVAL_MS = 20;
+
+    struct RingHolder {
+        std::shared_ptr<LogRing> ring;
+        ~RingHolder() {
+            if (ring) ring->orphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_cv_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    uint64_t flush_requests_ = 0;
+    uint64_t flushed_ = 0;
+    std::atomic<bool> stopped_{false};
+    std::thread drain_thread_;
+
+    LogBackend() : drain_thread_(&LogBackend::drainLoop, this) {
+    }
+
+    LogRing& localRing() {
+        thread_local RingHolder holder;
+        if (!holder.ring) {
+            holder.ring = std::make_shared<LogRing>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(holder.ring);
+        }
+        return *holder.ring;
+    }
+
+    void drainLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopped_.load(std::memory_order_acquire)) {
+            wake_.wait_for(lock, std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+            uint64_t requested = flush_requests_;
+
+            lock.unlock();
+            drainOnce();
+            lock.lock();
+
+            if (requested > flushed_) {
+                flushed_ = requested;
+                flushed_cv_.notify_all();
+            }
+        }
+    }
+
+    void drainOnce() {
+        std::vector<std::shared_ptr<LogRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Кольца завершившихся потоков удаляются, когда из них всё вычитано
+            rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<LogRing>& ring) {
+                return ring->orphaned.load(std::memory_order_acquire) && ring->empty();
+            }), rings_.end());
+            rings = rings_;
+        }
+
+        std::vector<LogRecord> batch;
+        int64_t dropped = 0;
+        LogRecord record;
+        for (const auto& ring : rings) {
+            while (ring->pop(record)) {
+                batch.push_back(std::move(record));
+            }
+            dropped += ring->takeDropped();
+        }
+
+        if (batch.empty() && dropped == 0) return;
+
+        // Каждое кольцо упорядочено само по себе; сливаем потоки по времени
+        std::stable_sort(batch.begin(), batch.end(), [](const LogRecord& a, const LogRecord& b) {
+            return a.time < b.time;
+        });
+
+        std::string out;
+        out.reserve(batch.size() * 96);
+        for (const auto& entry : batch) {
+            format(out, entry.level, entry.time, entry.message);
+        }
+        if (dropped > 0) {
+            format(out, Logger::WARNING, std::chrono::system_clock::now(),
+                   std::to_string(dropped) + " log messages dropped (ring buffer full)");
+        }
+        writeOut(out);
+    }
+
+public:
+    static void format(std::string& out, Logger::Level level, std::chrono::system_clock::time_point time,
+                       const std::string& message) {
+        const char* color = "";
+        const char* reset = "";
+
+        #ifdef __unix__
+        switch (level) {
+            case Logger::DEBUG:   color = "\033[36m"; break; // Cyan
+            case Logger::INFO:    color = "\033[32m"; break; // Green
+            case Logger::WARNING: color = "\033[33m"; break; // Yellow
+            case Logger::ERROR:   color = "\033[31m"; break; // Red
+            default:              color = "";
+        }
+        reset = "\033[0m";
+        #endif
+
+        out += '[';
+        appendTimestamp(out, time);
+        out += "] ";
+        out += color;
+        out += '[';
+        out += Logger::levelToString(level);
+        out += ']';
+        out += reset;
+        out += ' ';
+        out += message;
+        out += '\n';
+    }
+};
 
 void Logger::setLogLevel(Level level) {
-    current_level_ = level;
+    current_level = level;
     log(INFO, "Log level set to: " + levelToString(level));
 }
 
+bool Logger::isEnabled(Level level) {
+    return level >= current_level.load(std::memory_order_relaxed);
+}
+
+void Logger::setAsync(bool enabled) {
+    if (!enabled) {
+        flush();
+    }
+    async_enabled = enabled;
+}
+
+void Logger::flush() {
+    if (async_enabled) {
+        LogBackend::instance().flush();
+    }
+    std::fflush(stdout);
+}
+
 void Logger::log(Level level, const std::string& message) {
-    if (level >= current_level_) {
-        printLog(level, message);
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    if (async_enabled.load(std::memory_order_relaxed) && LogBackend::instance().enqueue(level, message)) {
+        return;
     }
+    printLog(level, message);
 }
 
 void Logger::debug(const std::string& message) {
@@ -40,52 +324,24 @@ void Logger::logQRDetection(const std::string& qrData, bool success) {
     }
 }
 
-void Logger::startOperation(const std::string& operation) {
-    log(DEBUG, "Starting: " + operation);
-}
-
-void Logger::endOperation(const std::string& operation) {
-    log(DEBUG, "Completed: " + operation);
-}
-
 std::string Logger::levelToString(Level level) {
     switch (level) {
         case DEBUG:   return "DEBUG";
         case INFO:    return "INFO";
         case WARNING: return "WARNING";
         case ERROR:   return "ERROR";
+        case OFF:     return "OFF";
         default:      return "UNKNOWN";
     }
 }
 
-std::string Logger::getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%H:%M:%S");
-    return ss.str();
-}
-
 void Logger::printLog(Level level, const std::string& message) {
-    std::string levelStr = levelToString(level);
-    std::string timeStr = getCurrentTime();
+    // Синхронный путь: после остановки фонового потока и при setAsync(false)
+    static std::mutex write_mutex;
 
-    std::string colorCode = "";
-    std::string resetCode = "";
+    std::string line;
+    LogBackend::format(line, level, std::chrono::system_clock::now(), message);
 
-    #ifdef __unix__
-    switch (level) {
-        case DEBUG:   colorCode = "\033[36m"; break; // Cyan
-        case INFO:    colorCode = "\033[32m"; break; // Green
-        case WARNING: colorCode = "\033[33m"; break; // Yellow
-        case ERROR:   colorCode = "\033[31m"; break; // Red
-        default:      colorCode = "";
-    }
-    resetCode = "\033[0m";
-    #endif
-
-    std::cout << "[" << timeStr << "] "
-              << colorCode << "[" << levelStr << "]" << resetCode
-              << " " << message << std::endl;
+    std::lock_guard<std::mutex> lock(write_mutex);
+    writeOut(line);
 }
@@ -4,16 +4,28 @@
 #include <string>
 #include <iostream>
 
+// QR_READER_MIN_LOG_LEVEL задаётся опцией CMake и попадает в сгенерированный qr_reader_config.h;
+// вызовы ниже него вместе с построением строки сообщения удаляются компилятором.
+#include "qr_reader_config.h"
+
 class Logger {
 public:
     enum Level {
         DEBUG,
         INFO,
         WARNING,
-        ERROR
+        ERROR,
+        OFF         // только для setLogLevel: вывод выключен полностью
     };
 
     static void setLogLevel(Level level);
+    static bool isEnabled(Level level);
+
+    // Асинхронный режим (по умолчанию): сообщение кладётся в кольцевой буфер потока,
+    // форматирует и пишет пачками фоновый поток. В синхронном режиме запись идёт сразу.
+    static void setAsync(bool enabled);
+    // Дожидается вывода всех сообщений, поставленных до вызова
+    static void flush();
 
     static void log(Level level, const std::string& message);
 
@@ -24,15 +36,24 @@ public:
 
     static void logQRDetection(const std::string& qrData, bool success);
 
-    static void startOperation(const std::string& operation);
-    static void endOperation(const std::string& operation);
-
 private:
-    static Level current_level_;
-
     static std::string levelToString(Level level);
-    static std::string getCurrentTime();
     static void printLog(Level level, const std::string& message);
+
+    friend class LogBackend;
 };
 
+// Сообщение вычисляется только если уровень вкомпилирован и включён
+#define QR_LOG_AT(level, ...)                                                       \
+    do {                                                                            \
+        if ((level) >= QR_READER_MIN_LOG_LEVEL && Logger::isEnabled(level)) {        \
+            Logger::log((level), __VA_ARGS__);                                      \
+        }                                                                           \
+    } while (0)
+
+#define QR_LOG_DEBUG(...) QR_LOG_AT(Logger::DEBUG, __VA_ARGS__)
+#define QR_LOG_INFO(...) QR_LOG_AT(Logger::INFO, __VA_ARGS__)
+#define QR_LOG_WARNING(...) QR_LOG_AT(Logger::WARNING, __VA_ARGS__)
+#define QR_LOG_ERROR(...) QR_LOG_AT(Logger::ERROR, __VA_ARGS__)
+
 #endif // QR_READER_LOGGER_H
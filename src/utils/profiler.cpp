@@ -0,0 +1,166 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct ThreadEntry {
+    const char* name;
+    Profiler::OperationStats stats;
+};
+
+// Таблица одного потока. Мьютекс захватывается владельцем без конкуренции
+// и нужен только на время слияния при collect()
+struct ThreadTable {
+    std::mutex mutex;
+    std::vector<ThreadEntry> entries;
+};
+
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Таблицы переживают свои потоки: статистика рабочих пула видна после join
+std::vector<std::shared_ptr<ThreadTable>>& registry() {
+    static std::vector<std::shared_ptr<ThreadTable>> tables;
+    return tables;
+}
+
+ThreadTable& localTable() {
+    thread_local std::shared_ptr<ThreadTable> table = [] {
+        auto created = std::make_shared<ThreadTable>();
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(created);
+        return created;
+    }();
+    return *table;
+}
+
+} // namespace
+
+std::atomic<bool> Profiler::enabled_{false};
+
+double Profiler::OperationStats::getAverageMs() const {
+    if (count == 0) return 0.0;
+    return total_ms / count;
+}
+
+double Profiler::OperationStats::getPercentileMs(double q) const {
+    if (count == 0) return 0.0;
+    int64_t rank = std::max<int64_t>(1, static_cast<int64_t>(q * count + 0.5));
+    int64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperBoundMs(i), max_ms);
+        }
+    }
+    return max_ms;
+}
+
+void Profiler::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::record(const char* name, double ms) {
+    ThreadTable& table = localTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    // Операций единицы, поиск по указателю дешевле любой хеш-таблицы
+    auto it = std::find_if(table.entries.begin(), table.entries.end(),
+                           [name](const ThreadEntry& entry) { return entry.name == name; });
+    if (it == table.entries.end()) {
+        table.entries.push_back({name, OperationStats()});
+        it = table.entries.end() - 1;
+        it->stats.name = name;
+    }
+
+    OperationStats& stats = it->stats;
+    stats.count++;
+    stats.total_ms += ms;
+    stats.max_ms = std::max(stats.max_ms, ms);
+    stats.buckets[bucketIndex(ms)]++;
+}
+
+std::vector<Profiler::OperationStats> Profiler::collect() {
+    std::vector<OperationStats> merged;
+
+    std::lock_guard<std::mutex> registry_lock(registryMutex());
+    for (const auto& table : registry()) {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        for (const auto& entry : table->entries) {
+            // Одинаковый литерал из разных единиц трансляции может иметь разные адреса
+            auto it = std::find_if(merged.begin(), merged.end(), [&](const OperationStats& stats) {
+                return stats.name == entry.stats.name;
+            });
+            if (it == merged.end()) {
+                merged.push_back(entry.stats);
+                continue;
+            }
+            it->count += entry.stats.count;
+            it->total_ms += entry.stats.total_ms;
+            it->max_ms = std::max(it->max_ms, entry.stats.max_ms);
+            for (int i = 0; i < BUCKET_COUNT; ++i) {
+                it->buckets[i] += entry.stats.buckets[i];
+            }
+        }
+    }
+
+    std::sort(merged.begin(), merged.end(), [](const OperationStats& a, const OperationStats& b) {
+        return a.total_ms > b.total_ms;
+    });
+    return merged;
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> registry_lock(registryMutex());
+    for (const auto& table : registry()) {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        table->entries.clear();
+    }
+}
+
+void Profiler::dump(std::ostream& out) {
+    auto operations = collect();
+    if (operations.empty()) return;
+
+    out << "Profile (count / total ms / avg ms / p50 ms / p99 ms / max ms):" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for (const auto& stats : operations) {
+        out << "  " << stats.name << ": " << stats.count << " / " << stats.total_ms << " / "
+            << stats.getAverageMs() << " / " << stats.getPercentileMs(0.50) << " / "
+            << stats.getPercentileMs(0.99) << " / " << stats.max_ms << std::endl;
+    }
+}
+
+void Profiler::dumpAtExit() {
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+        // Реестр создаётся до регистрации обработчика, иначе он будет разрушен раньше вывода
+        registryMutex();
+        registry();
+        std::atexit([] { Profiler::dump(std::cerr); });
+    });
+}
+
+int Profiler::bucketIndex(double ms) {
+    int64_t us = static_cast<int64_t>(ms * 1000.0);
+    if (us < 4) return static_cast<int>(std::max<int64_t>(us, 0));
+
+    int exponent = 0;
+    for (int64_t v = us; v > 1; v >>= 1) exponent++;
+    int sub = static_cast<int>((us >> (exponent - 2)) & 3);
+    return std::min(4 * (exponent - 1) + sub, BUCKET_COUNT - 1);
+}
+
+double Profiler::bucketUpperBoundMs(int index) {
+    if (index < 4) return (index + 1) / 1000.0;
+    int exponent = index / 4 + 1;
+    int sub = index % 4;
+    return static_cast<double>(static_cast<int64_t>(4 + sub + 1) << (exponent - 2)) / 1000.0;
+}
@@ -0,0 +1,77 @@
+#ifndef QR_READER_PROFILER_H
+#define QR_READER_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Счётчики и гистограммы длительностей операций. Каждый поток пишет в свою
+// локальную таблицу; collect()/dump() сливают таблицы всех потоков, включая
+// уже завершившиеся. В выключенном состоянии ScopedTimer не читает часы.
+class Profiler {
+public:
+    // Четыре корзины на каждую степень двойки микросекунд
+    static const int BUCKET_COUNT = 124;
+
+    struct OperationStats {
+        std::string name;
+        int64_t count = 0;
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+        std::array<int64_t, BUCKET_COUNT> buckets{};
+
+        double getAverageMs() const;
+        // Верхняя граница корзины, в которую попадает перцентиль q
+        double getPercentileMs(double q) const;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // name — строковый литерал: таблица потока хранит указатель, а не копию
+    static void record(const char* name, double ms);
+
+    static std::vector<OperationStats> collect();
+    static void reset();
+    static void dump(std::ostream& out);
+    // Однократно регистрирует вывод в std::cerr при завершении процесса
+    static void dumpAtExit();
+
+private:
+    static std::atomic<bool> enabled_;
+
+    static int bucketIndex(double ms);
+    static double bucketUpperBoundMs(int index);
+};
+
+// RAII-таймер области: длительность записывается в Profiler при выходе из области
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name)
+        : name_(name), active_(Profiler::isEnabled()) {
+        if (active_) start_ = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        if (active_) {
+            Profiler::record(name_, std::chrono::duration<double, std::milli>(
+                                        std::chrono::steady_clock::now() - start_).count());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // QR_READER_PROFILER_H
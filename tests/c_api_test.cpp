@@ -0,0 +1,111 @@
+#include "tests.h"
+#include "api/qr_reader_c.h"
+#include "bench/corpus_generator.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Чистый образец корпуса: без поворота, размытия, шума и перспективы
+bench::CorpusSample cleanSample() {
+    bench::CorpusConfig config;
+    config.count = 1;
+    config.min_module_px = 6;
+    config.max_module_px = 6;
+    config.max_rotation_deg = 0.0;
+    config.max_blur_sigma = 0.0;
+    config.max_noise_stddev = 0.0;
+    config.max_perspective = 0.0;
+    config.max_lighting = 0.0;
+    return bench::generateCorpus(config).front();
+}
+
+void checkFound(int status, const qr_reader_result& result, const std::string& payload) {
+    QR_CHECK(status == QR_READER_FOUND);
+    QR_CHECK(result.code_count >= 1 && result.codes != nullptr);
+    if (status != QR_READER_FOUND || result.code_count == 0) return;
+
+    const qr_reader_code& code = result.codes[0];
+    QR_CHECK(std::string(code.data, code.data_size) == payload);
+    QR_CHECK(code.data[code.data_size] == '\0');
+    QR_CHECK(code.confidence > 0.0 && code.confidence <= 1.0);
+}
+
+void checkDecode(qr_reader_detector* detector, const bench::CorpusSample& sample) {
+    const cv::Mat& bgr = sample.image;
+    cv::Mat gray;
+    cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+    qr_reader_result result;
+
+    int status = qr_reader_decode(detector, gray.data, gray.cols, gray.rows, gray.step,
+                                  QR_READER_PIXEL_GRAY8, &result);
+    checkFound(status, result, sample.payload);
+    qr_reader_result_free(&result);
+    QR_CHECK(result.codes == nullptr && result.code_count == 0);
+
+    // Строка с выравниванием: stride больше ширины, кадр внутри большего буфера
+    cv::Mat padded(bgr.rows, bgr.cols + 13, CV_8UC3, cv::Scalar(255, 255, 255));
+    bgr.copyTo(padded(cv::Rect(0, 0, bgr.cols, bgr.rows)));
+    status = qr_reader_decode(detector, padded.data, bgr.cols, bgr.rows, padded.step,
+                              QR_READER_PIXEL_BGR24, &result);
+    checkFound(status, result, sample.payload);
+    qr_reader_result_free(&result);
+
+    std::vector<uchar> png;
+    QR_CHECK(cv::imencode(".png", gray, png));
+    status = qr_reader_decode_encoded(detector, png.data(), png.size(), &result);
+    checkFound(status, result, sample.payload);
+    qr_reader_result_free(&result);
+}
+
+void checkErrors(qr_reader_detector* detector) {
+    qr_reader_result result;
+
+    cv::Mat blank(200, 200, CV_8UC1, cv::Scalar(255));
+    QR_CHECK(qr_reader_decode(detector, blank.data, blank.cols, blank.rows, blank.step,
+                              QR_READER_PIXEL_GRAY8, &result) == QR_READER_NOT_FOUND);
+    QR_CHECK(result.code_count == 0 && result.codes == nullptr);
+    qr_reader_result_free(&result);
+
+    QR_CHECK(qr_reader_decode(detector, nullptr, 10, 10, 10, QR_READER_PIXEL_GRAY8, &result) ==
+             QR_READER_ERROR_INVALID_ARGUMENT);
+    QR_CHECK(result.error_message[0] != '\0');
+    QR_CHECK(qr_reader_decode(detector, blank.data, 200, 200, 199, QR_READER_PIXEL_GRAY8, &result) ==
+             QR_READER_ERROR_INVALID_ARGUMENT);
+    QR_CHECK(qr_reader_decode(detector, blank.data, 50, 50, 200, static_cast<qr_reader_pixel_format>(9),
+                              &result) == QR_READER_ERROR_INVALID_ARGUMENT);
+    QR_CHECK(qr_reader_decode(nullptr, blank.data, 200, 200, 200, QR_READER_PIXEL_GRAY8, &result) ==
+             QR_READER_ERROR_INVALID_ARGUMENT);
+    QR_CHECK(qr_reader_decode(detector, blank.data, 200, 200, 200, QR_READER_PIXEL_GRAY8, nullptr) ==
+             QR_READER_ERROR_INVALID_ARGUMENT);
+
+    const uint8_t garbage[] = {'n', 'o', 't', ' ', 'a', 'n', ' ', 'i', 'm', 'a', 'g', 'e'};
+    QR_CHECK(qr_reader_decode_encoded(detector, garbage, sizeof(garbage), &result) == QR_READER_ERROR_DECODE);
+    QR_CHECK(qr_reader_decode_encoded(detector, garbage, 0, &result) == QR_READER_ERROR_INVALID_ARGUMENT);
+    qr_reader_result_free(&result);
+}
+
+} // namespace
+
+int runCApiTest() {
+    QR_CHECK(qr_reader_version() != nullptr && qr_reader_version()[0] != '\0');
+    QR_CHECK(qr_reader_set_log_level(static_cast<qr_reader_log_level>(99)) == QR_READER_ERROR_INVALID_ARGUMENT);
+    QR_CHECK(qr_reader_set_log_level(QR_READER_LOG_ERROR) == 0);
+
+    qr_reader_detector* detector = qr_reader_create();
+    QR_CHECK(detector != nullptr);
+    if (!detector) return tests::failureCount();
+
+    bench::CorpusSample sample = cleanSample();
+    checkDecode(detector, sample);
+
+    qr_reader_set_multi(detector, 1);
+    checkDecode(detector, sample);
+
+    qr_reader_set_preprocessing(detector, 0);
+    checkErrors(detector);
+
+    qr_reader_destroy(detector);
+    return tests::failureCount();
+}
@@ -0,0 +1,122 @@
+#include "tests.h"
+#include "service/decode_protocol.h"
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace decode_protocol;
+
+namespace {
+
+void checkEndpoints() {
+    Endpoint endpoint;
+    QR_CHECK(parseEndpoint("unix:/tmp/qr.sock", endpoint) && !endpoint.is_tcp && endpoint.path == "/tmp/qr.sock");
+    QR_CHECK(parseEndpoint("/tmp/plain.sock", endpoint) && !endpoint.is_tcp && endpoint.path == "/tmp/plain.sock");
+    QR_CHECK(parseEndpoint("tcp:8080", endpoint) && endpoint.is_tcp && endpoint.port == 8080);
+
+    QR_CHECK(!parseEndpoint("tcp:0", endpoint));
+    QR_CHECK(!parseEndpoint("tcp:65536", endpoint));
+    QR_CHECK(!parseEndpoint("tcp:port", endpoint));
+    QR_CHECK(!parseEndpoint("unix:", endpoint));
+    QR_CHECK(!parseEndpoint("", endpoint));
+}
+
+// Запрос с телом больше буфера сокета: writeFrame обязан дослать его частями,
+// а readInto — собрать целиком
+void checkRequestRoundTrip(int client, int server) {
+    std::vector<unsigned char> payload(3 << 20);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<unsigned char>(i * 31 + 7);
+    }
+
+    RequestHeader sent;
+    sent.request_id = 42;
+    sent.kind = PAYLOAD_GRAY;
+    sent.flags = FLAG_MULTI;
+    sent.width = 1024;
+    sent.height = 1024;
+    sent.stride = 3072;
+    sent.payload_size = static_cast<uint32_t>(payload.size());
+
+    bool written = false;
+    std::thread writer([&] {
+        written = writeFrame(client, &sent, sizeof(sent), payload.data(), payload.size());
+    });
+
+    RequestHeader received;
+    std::vector<unsigned char> body;
+    bool header_ok = readExact(server, &received, sizeof(received));
+    bool body_ok = header_ok && readInto(server, body, received.payload_size);
+    writer.join();
+
+    QR_CHECK(written);
+    QR_CHECK(header_ok && body_ok);
+    QR_CHECK(received.magic == REQUEST_MAGIC);
+    QR_CHECK(received.request_id == 42);
+    QR_CHECK(received.kind == PAYLOAD_GRAY);
+    QR_CHECK(received.flags == FLAG_MULTI);
+    QR_CHECK(received.width == 1024 && received.height == 1024 && received.stride == 3072);
+    QR_CHECK(body == payload);
+}
+
+void checkResponseRoundTrip(int client, int server) {
+    const std::string record = "{\"source\":\"request-7\",\"success\":true,\"data\":\"hello\"}\n";
+
+    ResponseHeader sent;
+    sent.request_id = 7;
+    sent.status = STATUS_DECODED;
+    sent.payload_size = static_cast<uint32_t>(record.size());
+    QR_CHECK(writeFrame(server, &sent, sizeof(sent), record.data(), record.size()));
+
+    ResponseHeader received;
+    std::vector<unsigned char> body;
+    QR_CHECK(readExact(client, &received, sizeof(received)));
+    QR_CHECK(received.magic == RESPONSE_MAGIC && received.request_id == 7 && received.status == STATUS_DECODED);
+    QR_CHECK(readInto(client, body, received.payload_size));
+    QR_CHECK(std::string(body.begin(), body.end()) == record);
+
+    // Кадр без тела уходит одним заголовком
+    ResponseHeader empty;
+    empty.request_id = 8;
+    empty.status = STATUS_NOT_FOUND;
+    QR_CHECK(writeFrame(server, &empty, sizeof(empty), nullptr, 0));
+    QR_CHECK(readExact(client, &received, sizeof(received)));
+    QR_CHECK(received.request_id == 8 && received.status == STATUS_NOT_FOUND && received.payload_size == 0);
+}
+
+// Оборванное соединение: заявленный размер больше присланного — ошибка, а не зависание
+void checkTruncatedPayload(int client, int server) {
+    const char partial[] = "0123456789";
+    QR_CHECK(writeExact(client, partial, sizeof(partial)));
+    ::shutdown(client, SHUT_WR);
+
+    std::vector<unsigned char> body;
+    QR_CHECK(!readInto(server, body, 1 << 20));
+
+    char byte;
+    QR_CHECK(!readExact(server, &byte, 1));
+}
+
+} // namespace
+
+int runProtocolTest() {
+    checkEndpoints();
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        tests::reportFailure(__FILE__, __LINE__, "socketpair");
+        return tests::failureCount();
+    }
+
+    checkRequestRoundTrip(fds[0], fds[1]);
+    checkResponseRoundTrip(fds[0], fds[1]);
+    checkTruncatedPayload(fds[0], fds[1]);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return tests::failureCount();
+}
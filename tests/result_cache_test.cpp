@@ -0,0 +1,106 @@
+#include "tests.h"
+#include "io/result_cache.h"
+#include <fstream>
+#include <string>
+
+namespace {
+
+QRDetector::DetectionResult decoded(const std::string& data) {
+    QRDetector::DetectionResult result;
+    result.success = true;
+    result.data = data;
+    result.confidence = 0.875;
+    result.preprocessing_stage = "clahe";
+    result.bounding_box = {{10, 20}, {110, 20}, {110, 120}, {10, 120}};
+    return result;
+}
+
+bool sameResult(const QRDetector::DetectionResult& a, const QRDetector::DetectionResult& b) {
+    if (a.success != b.success || a.data != b.data || a.confidence != b.confidence ||
+        a.preprocessing_stage != b.preprocessing_stage || a.codes.size() != b.codes.size() ||
+        a.bounding_box.size() != b.bounding_box.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.bounding_box.size(); ++i) {
+        if (a.bounding_box[i] != b.bounding_box[i]) return false;
+    }
+    for (size_t i = 0; i < a.codes.size(); ++i) {
+        if (a.codes[i].data != b.codes[i].data || a.codes[i].confidence != b.codes[i].confidence ||
+            a.codes[i].bounding_box.size() != b.codes[i].bounding_box.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Записи переживают перезапуск, включая данные с разделителями журнала внутри
+void checkJournalReload(const ResultCache::Config& config) {
+    QRDetector::DetectionResult plain = decoded("https://example.com/?a=1&b=2");
+    QRDetector::DetectionResult tricky = decoded("tab\there\nnewline\\backslash\r");
+    tricky.codes.push_back({"tab\there\nnewline\\backslash\r", tricky.bounding_box, 0.875});
+    tricky.codes.push_back({"second", {{1, 2}, {3, 4}, {5, 6}, {7, 8}}, 0.25});
+    QRDetector::DetectionResult failed;
+    failed.error_message = "No QR code found";
+
+    {
+        ResultCache cache(config);
+        cache.insert(1, plain);
+        cache.insert(2, tricky);
+        cache.insert(3, failed);
+
+        QRDetector::DetectionResult hit;
+        QR_CHECK(cache.lookup(3, hit) && !hit.success);
+    }
+
+    ResultCache reloaded(config);
+    QRDetector::DetectionResult hit;
+    QR_CHECK(reloaded.lookup(1, hit) && sameResult(hit, plain));
+    QR_CHECK(reloaded.lookup(2, hit) && sameResult(hit, tricky));
+    // Неудачи живут только в памяти процесса
+    QR_CHECK(!reloaded.lookup(3, hit));
+    QR_CHECK(!reloaded.lookup(4, hit));
+
+    ResultCache::CacheStats stats = reloaded.getStats();
+    QR_CHECK(stats.disk_hits == 2);
+    QR_CHECK(stats.misses == 2);
+}
+
+// Оборванная падением последняя строка не склеивается со следующей записью
+void checkTornTail(const ResultCache::Config& config, const std::string& journal) {
+    {
+        std::ofstream out(journal, std::ios::app | std::ios::binary);
+        out << "5\t1\t0.5\t\tra";
+    }
+    {
+        ResultCache cache(config);
+        QRDetector::DetectionResult hit;
+        QR_CHECK(!cache.lookup(5, hit));
+        cache.insert(6, decoded("after crash"));
+    }
+
+    ResultCache reloaded(config);
+    QRDetector::DetectionResult hit;
+    QR_CHECK(reloaded.lookup(6, hit) && hit.data == "after crash");
+    QR_CHECK(reloaded.lookup(1, hit) && hit.data == "https://example.com/?a=1&b=2");
+    QR_CHECK(!reloaded.lookup(5, hit));
+}
+
+} // namespace
+
+int runResultCacheTest() {
+    ResultCache::Config config;
+    config.disk_directory = tests::makeTempDirectory("result_cache");
+    // Одна запись в памяти: почти всё читается через журнал
+    config.memory_capacity = 1;
+
+    checkJournalReload(config);
+    checkTornTail(config, config.disk_directory + "/results.journal");
+
+    // Ключ зависит и от содержимого, и от отпечатка настроек
+    uint64_t content = ResultCache::hashString("payload");
+    QR_CHECK(content == ResultCache::hashString("payload"));
+    QR_CHECK(ResultCache::combineKey(content, 1) != ResultCache::combineKey(content, 2));
+    QR_CHECK(ResultCache::hashString("payload") != ResultCache::hashString("payloae"));
+
+    return tests::failureCount();
+}
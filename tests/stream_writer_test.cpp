@@ -0,0 +1,132 @@
+#include "tests.h"
+#include "io/result_stream_writer.h"
+#include <chrono>
+#include <fstream>
+#include <string>
+
+namespace {
+
+const std::chrono::system_clock::time_point RECORD_TIME{std::chrono::seconds(1700000000)};
+
+QRDetector::DetectionResult decoded(const std::string& data) {
+    QRDetector::DetectionResult result;
+    result.success = true;
+    result.data = data;
+    result.confidence = 0.5;
+    result.preprocessing_stage = "raw";
+    result.bounding_box = {{1, 2}, {3, 4}, {5, 6}, {7, 8}};
+    return result;
+}
+
+std::string record(ResultStreamWriter::Format format, const std::string& source,
+                   const QRDetector::DetectionResult& result) {
+    std::string out;
+    ResultStreamWriter::appendRecord(out, format, source, result, RECORD_TIME);
+    return out;
+}
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+void checkJsonEscaping() {
+    std::string json = record(ResultStreamWriter::JSONL, "dir/\"quoted\".png",
+                              decoded("a\"b\\c\nd\te\x01 Привет"));
+    QR_CHECK(json.back() == '\n');
+    QR_CHECK(json.find('\n') == json.size() - 1);
+    QR_CHECK(contains(json, "\"source\":\"dir/\\\"quoted\\\".png\""));
+    QR_CHECK(contains(json, "\"data\":\"a\\\"b\\\\c\\nd\\te\\u0001 Привет\""));
+    QR_CHECK(contains(json, "\"success\":true"));
+    QR_CHECK(contains(json, "\"confidence\":0.5000"));
+    QR_CHECK(contains(json, "\"bounding_box\":[[1,2],[3,4],[5,6],[7,8]]"));
+
+    QRDetector::DetectionResult failed;
+    failed.error_message = "No \"QR\" code";
+    json = record(ResultStreamWriter::JSONL, "x.png", failed);
+    QR_CHECK(contains(json, "\"success\":false"));
+    QR_CHECK(contains(json, "\"error\":\"No \\\"QR\\\" code\""));
+    QR_CHECK(!contains(json, "\"data\""));
+}
+
+// Данные не в UTF-8 идут полем data_base64; проверяются все три варианта хвоста
+void checkBase64() {
+    std::string json = record(ResultStreamWriter::JSONL, "bin", decoded(std::string("\xff\xfe\x00" "A", 4)));
+    QR_CHECK(contains(json, "\"data_base64\":\"//4AQQ==\""));
+    QR_CHECK(!contains(json, "\"data\":"));
+
+    json = record(ResultStreamWriter::JSONL, "bin", decoded("\xff"));
+    QR_CHECK(contains(json, "\"data_base64\":\"/w==\""));
+    json = record(ResultStreamWriter::JSONL, "bin", decoded("\xff\xfe"));
+    QR_CHECK(contains(json, "\"data_base64\":\"//4=\""));
+    json = record(ResultStreamWriter::JSONL, "bin", decoded("\xff\xfe\xfd"));
+    QR_CHECK(contains(json, "\"data_base64\":\"//79\""));
+
+    // Избыточная форма и суррогат — тоже не UTF-8
+    json = record(ResultStreamWriter::JSONL, "bin", decoded("\xc0\xaf"));
+    QR_CHECK(contains(json, "\"data_base64\":\"wK8=\""));
+    json = record(ResultStreamWriter::JSONL, "bin", decoded("\xed\xa0\x80"));
+    QR_CHECK(contains(json, "\"data_base64\":\"7aCA\""));
+
+    // В мульти-режиме решение принимается для каждого кода отдельно
+    QRDetector::DetectionResult multi = decoded("text");
+    multi.codes.push_back({"text", {{0, 0}}, 0.9});
+    multi.codes.push_back({"\xff", {{1, 1}}, 0.8});
+    json = record(ResultStreamWriter::JSONL, "multi", multi);
+    QR_CHECK(contains(json, "\"codes\":[{\"data\":\"text\",\"confidence\":0.9000,\"bounding_box\":[[0,0]]},"
+                            "{\"data_base64\":\"/w==\",\"confidence\":0.8000,\"bounding_box\":[[1,1]]}]"));
+}
+
+void checkCsvEscaping() {
+    std::string csv = record(ResultStreamWriter::CSV, "a,b.png", decoded("say \"hi\""));
+    size_t comma = csv.find(',');
+    QR_CHECK(comma != std::string::npos);
+    QR_CHECK(csv.compare(comma, std::string::npos,
+                         ",\"a,b.png\",1,\"say \"\"hi\"\"\",0.5000,raw,1,1 2;3 4;5 6;7 8,"
+                         "0.000,0.000,0.000,\n") == 0);
+
+    csv = record(ResultStreamWriter::CSV, "plain.png", decoded("line1\nline2"));
+    QR_CHECK(contains(csv, ",plain.png,1,\"line1\nline2\","));
+
+    QRDetector::DetectionResult failed;
+    failed.error_message = "bad, \"frame\"";
+    csv = record(ResultStreamWriter::CSV, "f.png", failed);
+    QR_CHECK(contains(csv, ",f.png,0,,,,0,,"));
+    QR_CHECK(contains(csv, ",\"bad, \"\"frame\"\"\"\n"));
+}
+
+// Заголовок CSV пишется только в пустой файл — дозапись его не повторяет
+void checkCsvFile() {
+    ResultStreamWriter::Config config;
+    config.path = tests::makeTempDirectory("stream_writer") + "/results.csv";
+    config.format = ResultStreamWriter::CSV;
+
+    for (int run = 0; run < 2; ++run) {
+        ResultStreamWriter writer(config);
+        QR_CHECK(writer.open());
+        writer.write("first.png", decoded("one"), RECORD_TIME);
+        writer.write("second.png", decoded("two"), RECORD_TIME);
+        writer.close();
+        QR_CHECK(writer.getStats().records == 2);
+    }
+
+    std::ifstream in(config.path);
+    std::string line;
+    int lines = 0;
+    int headers = 0;
+    while (std::getline(in, line)) {
+        lines++;
+        if (line.compare(0, 10, "timestamp,") == 0) headers++;
+    }
+    QR_CHECK(lines == 5);
+    QR_CHECK(headers == 1);
+}
+
+} // namespace
+
+int runStreamWriterTest() {
+    checkJsonEscaping();
+    checkBase64();
+    checkCsvEscaping();
+    checkCsvFile();
+    return tests::failureCount();
+}
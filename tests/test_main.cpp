@@ -0,0 +1,63 @@
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include "qr_reader_config.h"
+#include "tests.h"
+#include "utils/logger.h"
+
+namespace tests {
+
+namespace {
+int failures = 0;
+}
+
+void reportFailure(const char* file, int line, const char* expression) {
+    failures++;
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+}
+
+int failureCount() {
+    return failures;
+}
+
+std::string makeTempDirectory(const std::string& name) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / ("qr_reader_tests_" + name);
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory.string();
+}
+
+} // namespace tests
+
+int main(int argc, char** argv) {
+    const std::map<std::string, int (*)()> suites = {
+        {"c_api", runCApiTest},
+#ifdef QR_READER_LINUX
+        {"protocol", runProtocolTest},
+#endif
+        {"result_cache", runResultCacheTest},
+        {"stream_writer", runStreamWriterTest},
+    };
+
+    if (argc != 2 || suites.find(argv[1]) == suites.end()) {
+        std::cerr << "Usage: qr_tests <test>" << std::endl;
+        std::cerr << "Tests:" << std::endl;
+        for (const auto& entry : suites) {
+            std::cerr << "  " << entry.first << std::endl;
+        }
+        return 1;
+    }
+
+    // Синхронный вывод: сообщения библиотеки идут вперемешку с провалами в порядке событий
+    Logger::setAsync(false);
+    Logger::setLogLevel(Logger::WARNING);
+
+    int failed = suites.at(argv[1])();
+    if (failed > 0) {
+        std::cerr << argv[1] << ": " << failed << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << argv[1] << ": passed" << std::endl;
+    return 0;
+}
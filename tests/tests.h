@@ -0,0 +1,30 @@
+#ifndef QR_READER_TESTS_H
+#define QR_READER_TESTS_H
+
+#include <string>
+
+// Каждый тест возвращает число проваленных проверок; 0 — тест пройден.
+int runProtocolTest();
+int runStreamWriterTest();
+int runResultCacheTest();
+int runCApiTest();
+
+namespace tests {
+
+// Проверка не прерывает тест: провал печатается с местом и учитывается в итоге
+void reportFailure(const char* file, int line, const char* expression);
+int failureCount();
+
+// Пустой каталог во временной директории под файлы теста
+std::string makeTempDirectory(const std::string& name);
+
+} // namespace tests
+
+#define QR_CHECK(expression)                                                        \
+    do {                                                                            \
+        if (!(expression)) {                                                        \
+            tests::reportFailure(__FILE__, __LINE__, #expression);                  \
+        }                                                                           \
+    } while (0)
+
+#endif // QR_READER_TESTS_H